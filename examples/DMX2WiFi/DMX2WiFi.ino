@@ -57,6 +57,7 @@ void blinkLED() {
 }
 
 int got_dmx = 0;
+int dmx_input_started = 0;
 void gotDMXCallback(int slots);
 IPAddress send_address;
 
@@ -84,6 +85,7 @@ void setup() {
   } else {
     interface = new LXWiFiArtNet(WiFi.localIP(), WiFi.subnetMask());
     use_multicast = 0;
+    ((LXWiFiArtNet*)interface)->enableSubscriberUnicast(1);  // unicast to nodes found by ArtPoll
     //((LXWiFiArtNet*)interface)->setSubnetUniverse(0, 0); // for different subnet/universe, change this line
   }
 
@@ -121,21 +123,44 @@ void gotDMXCallback(int slots) {
 *************************************************************************/
 
 void loop() {
+  uint8_t sent;
   if ( got_dmx ) {
     //interface->setNumberOfSlots(got_dmx);
     for(int i=1; i<=got_dmx; i++) {
       interface->setSlot(i, ESP8266DMX.getSlot(i));
     }
+    got_dmx = 0;
+    dmx_input_started = 1;
+  } //got_dmx
+
+  // nothing is sent until DMX input is received
+  if ( dmx_input_started ) {
+    // sent when levels change, otherwise only refreshed
     if ( use_multicast ) {
        if ( make_access_point ) {
-          interface->sendDMX(&wUDP, send_address, WiFi.softAPIP());
+          sent = interface->sendDMXOnChange(&wUDP, send_address, WiFi.softAPIP());
        } else {
-          interface->sendDMX(&wUDP, send_address, WiFi.localIP());
+          sent = interface->sendDMXOnChange(&wUDP, send_address, WiFi.localIP());
        }
     } else {
-       interface->sendDMX(&wUDP, send_address, INADDR_NONE);
+       sent = interface->sendDMXOnChange(&wUDP, send_address, INADDR_NONE);
     }
-    got_dmx = 0;
-    blinkLED();
-  } //got_dmx
+    if ( sent ) {
+      blinkLED();
+    }
+  }
+
+  if ( use_sacn ) {
+    // lets receivers find the universe being sent
+    if ( dmx_input_started ) {
+      if ( make_access_point ) {
+        ((LXWiFiSACN*)interface)->sendUniverseDiscoveryOnInterval(&wUDP, WiFi.softAPIP());
+      } else {
+        ((LXWiFiSACN*)interface)->sendUniverseDiscoveryOnInterval(&wUDP, WiFi.localIP());
+      }
+    }
+  } else {
+    // answers ArtPoll and finds nodes to unicast to from ArtPollReply
+    ((LXWiFiArtNet*)interface)->readArtNetPacketInputMode(&wUDP);
+  }
 }
@@ -230,7 +230,15 @@ void loop() {
 		#endif
 		
 		if ( (art_packet_result == RESULT_DMX_RECEIVED) || (acn_packet_result == RESULT_DMX_RECEIVED) ) {
-			copyDMXToOutput();
+			uint16_t first = DMX_UNIVERSE_SIZE + 1;
+			uint16_t last = 0;
+			if ( art_packet_result == RESULT_DMX_RECEIVED ) {
+				addChangedSlots(artNetInterface, &first, &last);
+			}
+			if ( acn_packet_result == RESULT_DMX_RECEIVED ) {
+				addChangedSlots(sACNInterface, &first, &last);
+			}
+			copyDMXToOutput(first, last);
 			blinkLED();
 		}
 		
@@ -304,18 +312,42 @@ void artIpProgReceived(uint8_t cmd, IPAddress addr, IPAddress subnet) {
    }
 }
 
+/************************************************************************
+
+  Expands the range first-last to include the slots changed
+  by the last packet read by interface
+
+*************************************************************************/
+
+void addChangedSlots(LXDMXWiFi* interface, uint16_t* first, uint16_t* last) {
+  uint16_t f = interface->changedSlotsFirst();
+  if ( f ) {                    // zero if no slots changed
+    if ( f < *first ) {
+      *first = f;
+    }
+    if ( interface->changedSlotsLast() > *last ) {
+      *last = interface->changedSlotsLast();
+    }
+  }
+}
+
 /************************************************************************
 
   Copy to output merges slots for Art-Net and sACN on HTP basis
+  skipped if the slots first to last (changed by the packets just read)
+  do not include any of this sketch's addresses
   
 *************************************************************************/
 
-void copyDMXToOutput(void) {
+void copyDMXToOutput(uint16_t first, uint16_t last) {
   uint8_t a, s;
   uint16_t a_slots = artNetInterface->numberOfSlots();
   uint16_t s_slots = sACNInterface->numberOfSlots();
   uint16_t low_addr = DMXWiFiConfig.deviceAddress();
   uint16_t high_addr = DMXWiFiConfig.deviceAddress()+total_pixels;
+  if (( last < low_addr ) || ( first >= high_addr )) {
+    return;                     // no change to pixels
+  }
   for (int i=low_addr; i<high_addr; i++) {
     if ( i <= a_slots ) {
       a = artNetInterface->getSlot(i);
@@ -536,18 +536,38 @@ void setup() {
 
 } //setup
 
+/************************************************************************
+
+  Expands the range first-last to include the slots changed
+  by the last packet read by interface
+  
+*************************************************************************/
+
+void addChangedSlots(LXDMXWiFi* interface, uint16_t* first, uint16_t* last) {
+  uint16_t f = interface->changedSlotsFirst();
+  if ( f ) {                    // zero if no slots changed
+    if ( f < *first ) {
+      *first = f;
+    }
+    if ( interface->changedSlotsLast() > *last ) {
+      *last = interface->changedSlotsLast();
+    }
+  }
+}
+
 /************************************************************************
 
   Copy to output merges slots for Art-Net and sACN on HTP basis
+  only slots first to last (changed by the packets just read) are copied
 
 *************************************************************************/
 
-void copyDMXToOutput(void) {
+void copyDMXToOutput(uint16_t first, uint16_t last) {
   uint8_t a, s;
   uint16_t a_slots = artNetInterface->numberOfSlots();
   uint16_t s_slots = sACNInterface->numberOfSlots();
   xSemaphoreTake( ESP32DMX.lxDataLock, portMAX_DELAY );
-  for (int i = 1; i <= DMX_UNIVERSE_SIZE; i++) {
+  for (int i = first; i <= last; i++) {
     if ( i <= a_slots ) {
       a = artNetInterface->getSlot(i);
     } else {
@@ -618,11 +638,14 @@ void checkConfigReceived(LXDMXWiFi* interface, WiFiUDP* cUDP) {
 /************************************************************************
 
   Checks to see if the dmx callback indicates received dmx
-     If so, send it using the selected interface.
+     If so, copy it to the selected interface.
+  A packet is sent when the levels change, otherwise only at the refresh
+  rate of the protocol.
 
 *************************************************************************/
 
 uint8_t checkInput(LXDMXWiFi* interface, WiFiUDP* iUDP, uint8_t multicast) {
+  uint8_t sent;
   if ( got_dmx ) {
     interface->setNumberOfSlots(got_dmx);			// set slots & copy to interface
 
@@ -631,17 +654,18 @@ uint8_t checkInput(LXDMXWiFi* interface, WiFiUDP* iUDP, uint8_t multicast) {
       interface->setSlot(i, ESP32DMX.getSlot(i));
     }
     xSemaphoreGive( ESP32DMX.lxDataLock );
-    
-    if ( multicast ) {
-      interface->sendDMX(iUDP, DMXWiFiConfig.inputAddress(), local_ip_address);
-    } else {
-      interface->sendDMX(iUDP, DMXWiFiConfig.inputAddress(), INADDR_NONE);
-    }
     got_dmx = 0;
-    blinkLED();
-    return 1;
   }       // got_dmx
-  return 0;
+
+  if ( multicast ) {
+    sent = interface->sendDMXOnChange(iUDP, DMXWiFiConfig.inputAddress(), local_ip_address);
+  } else {
+    sent = interface->sendDMXOnChange(iUDP, DMXWiFiConfig.inputAddress(), INADDR_NONE);
+  }
+  if ( sent ) {
+    blinkLED();
+  }
+  return sent;
 }
 
 /************************************************************************
@@ -684,7 +708,17 @@ void loop() {
     vTaskDelay(1);
 
     if ( (art_packet_result == RESULT_DMX_RECEIVED) || (acn_packet_result == RESULT_DMX_RECEIVED) ) {
-      copyDMXToOutput();
+      uint16_t first = DMX_UNIVERSE_SIZE + 1;
+      uint16_t last = 0;
+      if ( art_packet_result == RESULT_DMX_RECEIVED ) {
+        addChangedSlots(artNetInterface, &first, &last);
+      }
+      if ( acn_packet_result == RESULT_DMX_RECEIVED ) {
+        addChangedSlots(sACNInterface, &first, &last);
+      }
+      if ( first <= last ) {
+        copyDMXToOutput(first, last);
+      }
       blinkLED();
     } else {
       // output was not updated last 5 times through loop so use a cycle to perform the next step of RDM discovery
@@ -570,7 +570,9 @@ void checkConfigReceived(LXDMXWiFi* interface, WiFiUDP cUDP) {
 /************************************************************************
 
   Checks to see if the dmx callback indicates received dmx
-     If so, send it using the selected interface.
+     If so, copy it to the selected interface.
+  A packet is sent when the levels change, otherwise only at the refresh
+  rate of the protocol.
   
 *************************************************************************/
 
@@ -580,14 +582,21 @@ void checkInput(LXDMXWiFi* interface, WiFiUDP* iUDP, uint8_t multicast) {
 		for(int i=1; i<=got_dmx; i++) {
 		  interface->setSlot(i, SAMD21DMX.getSlot(i));
 		}
-		if ( multicast ) {
-			interface->sendDMX(iUDP, DMXWiFiConfig.inputAddress(), WiFi.localIP());
-		} else {
-			interface->sendDMX(iUDP, DMXWiFiConfig.inputAddress(), INADDR_NONE);
-		}
-      got_dmx = 0;
-      blinkLED();
-    }       // got_dmx
+		got_dmx = 0;
+	}       // got_dmx
+
+	if ( interface->numberOfSlots() == 0 ) {
+		return;						// nothing is sent until DMX input is received
+	}
+	uint8_t sent;
+	if ( multicast ) {
+		sent = interface->sendDMXOnChange(iUDP, DMXWiFiConfig.inputAddress(), WiFi.localIP());
+	} else {
+		sent = interface->sendDMXOnChange(iUDP, DMXWiFiConfig.inputAddress(), INADDR_NONE);
+	}
+	if ( sent ) {
+		blinkLED();
+	}
 }
 
 /************************************************************************
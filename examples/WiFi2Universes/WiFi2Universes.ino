@@ -20,6 +20,7 @@
     @section  HISTORY
 
     v1.00 - First release
+    v1.01 - Art-Net universes are read through LXWiFiArtNetNode
 */
 /**************************************************************************/
 
@@ -28,6 +29,7 @@
 #include <WiFiUdp.h>
 #include <LXDMXWiFi.h>
 #include <LXWiFiArtNet.h>
+#include <LXWiFiArtNetNode.h>
 #include <LXWiFiSACN.h>
 
 // *** modify the following for setting up the WiFi connection ***
@@ -45,6 +47,9 @@ uint8_t use_multicast = 1;
 LXDMXWiFi* interface;
 LXDMXWiFi* interfaceUniverse2;
 
+// Art-Net node parses each packet once and dispatches ArtDMX to the matching universe
+LXWiFiArtNetNode* artNetNode;
+
 // buffer large enough to contain incoming packet
 uint8_t packetBuffer[SACN_BUFFER_MAX];
 
@@ -111,18 +116,10 @@ void setup() {
     interfaceUniverse2 = new LXWiFiSACN(&packetBuffer[0]);	//Note:  second universe does not work with multicast
     interfaceUniverse2->setUniverse(2);
   } else {
-    interface = new LXWiFiArtNet(WiFi.localIP(), WiFi.subnetMask(), &packetBuffer[0]);
-    //((LXWiFiArtNet*)interface)->setSubnetUniverse(0, 0);  //for different subnet/universe, change this line
-    
-    // this interface will handle poll replies, set reply fields for second port
-    uint8_t* pollReply = ((LXWiFiArtNet*)interface)->replyData();
-    pollReply[173] = 2;    // number of ports
-  	 pollReply[175] = 128;  //  can output from network (port2)
-  	 pollReply[183] = 128;  //  good output... change if error  (port2)
-    pollReply[191] = 1;    //  universe  (port2)
-    
-    interfaceUniverse2 = new LXWiFiArtNet(WiFi.localIP(), WiFi.subnetMask(), &packetBuffer[0]);
-    ((LXWiFiArtNet*)interfaceUniverse2)->setSubnetUniverse(0, 1);
+    artNetNode = new LXWiFiArtNetNode(WiFi.localIP(), WiFi.subnetMask());
+    interface = artNetNode->addUniverse(0);             //for different Port-Address, change this line
+    // the first universe handles poll replies, the reply includes the second universe as port 2
+    interfaceUniverse2 = artNetNode->addUniverse(1);
   }
 
   if ( use_multicast ) {                  // Start listening for UDP on port
@@ -152,37 +149,55 @@ void setup() {
 
   The main loop checks for and reads packets from WiFi UDP socket
   connection.  readDMXPacketContents() returns true when a DMX packet is received.
-  If the first universe does not match, try the second
+  With sACN, if the first universe does not match, try the second.
+  With Art-Net, the node finds the matching universe from the Port-Address.
 
 *************************************************************************/
 
 void loop() {
-  uint16_t packetSize = wUDP.parsePacket();
-  if ( packetSize ) {
-  	  packetSize = wUDP.read(packetBuffer, SACN_BUFFER_MAX);
-	  uint8_t read_result = interface->readDMXPacketContents(&wUDP, packetSize);
-	  uint8_t read_result2 = 0;
-
-	  if ( read_result == RESULT_DMX_RECEIVED ) {
-	     analogWrite(12,2*interface->getSlot(1));
-	  	  // for bandwidth testing, both universes are sent to output
-	     // Note:  ESP8266DMX can only output a single universe
-		  for (int i = 1; i <= interface->numberOfSlots(); i++) {
-			  ESP8266DMX.setSlot(i , interface->getSlot(i));
-		  }
-	  } else if ( read_result == RESULT_NONE ) {				// if not good_dmx first universe, try 2nd
-	     read_result2 = interfaceUniverse2->readDMXPacketContents(&wUDP, packetSize);
-	     if ( read_result2 == RESULT_DMX_RECEIVED ) {
-	     		// for bandwidth testing, first universe interface is sent to DMX output again
-	         // Note:  ESP8266DMX can only output a single universe
-	     		for (int i = 1; i <= interface->numberOfSlots(); i++) {
-			  	  ESP8266DMX.setSlot(i , interface->getSlot(i));
-		  		}
-		  		analogWrite(14,2*interfaceUniverse2->getSlot(512));
-	     }
-	  }
-	  if ( read_result || read_result2 ) {
-	  	  blinkLED();
+  uint8_t read_result = 0;
+  uint8_t read_result2 = 0;
+
+  if ( use_sacn ) {
+    uint16_t packetSize = wUDP.parsePacket();
+    if ( packetSize ) {
+      packetSize = wUDP.read(packetBuffer, SACN_BUFFER_MAX);
+      read_result = interface->readDMXPacketContents(&wUDP, packetSize);
+      if ( read_result == RESULT_NONE ) {				// if not good_dmx first universe, try 2nd
+        read_result2 = interfaceUniverse2->readDMXPacketContents(&wUDP, packetSize);
+      }
+    }
+  } else if ( artNetNode->readDMXPacket(&wUDP) == RESULT_DMX_RECEIVED ) {
+    if ( artNetNode->syncReceived() ) {       // ArtSync may update both universes at once
+      if ( interface->changedSlotsFirst() ) {
+        read_result = RESULT_DMX_RECEIVED;
+      }
+      if ( interfaceUniverse2->changedSlotsFirst() ) {
+        read_result2 = RESULT_DMX_RECEIVED;
+      }
+    } else if ( artNetNode->receivedUniverse() == interface ) {
+      read_result = RESULT_DMX_RECEIVED;
+    } else {
+      read_result2 = RESULT_DMX_RECEIVED;
+    }
+  }
+
+  if ( read_result == RESULT_DMX_RECEIVED ) {
+     analogWrite(12,2*interface->getSlot(1));
+  	  // for bandwidth testing, both universes are sent to output
+     // Note:  ESP8266DMX can only output a single universe
+	  for (int i = 1; i <= interface->numberOfSlots(); i++) {
+		  ESP8266DMX.setSlot(i , interface->getSlot(i));
 	  }
-	}
+  } else if ( read_result2 == RESULT_DMX_RECEIVED ) {
+     // for bandwidth testing, first universe interface is sent to DMX output again
+     // Note:  ESP8266DMX can only output a single universe
+     for (int i = 1; i <= interface->numberOfSlots(); i++) {
+	     ESP8266DMX.setSlot(i , interface->getSlot(i));
+     }
+     analogWrite(14,2*interfaceUniverse2->getSlot(512));
+  }
+  if ( read_result || read_result2 ) {
+  	  blinkLED();
+  }
 }
@@ -0,0 +1,30 @@
+/* Arduino.h
+   host stand-in for building LXDMXWiFi on Linux/POSIX
+   see LXDMXWiFi.h for LICENSE
+*/
+
+#ifndef LXDMXWIFI_HOST_ARDUINO_H
+#define LXDMXWIFI_HOST_ARDUINO_H
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "IPAddress.h"
+
+inline unsigned long millis ( void ) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (unsigned long)(t.tv_sec * 1000UL + t.tv_nsec / 1000000L);
+}
+
+inline long random ( long howbig ) {
+	return ( howbig > 0 ) ? ( ::random() % howbig ) : 0;
+}
+
+inline long random ( long howsmall, long howbig ) {
+	return ( howsmall < howbig ) ? ( howsmall + random(howbig - howsmall) ) : howsmall;
+}
+
+#endif // ifndef LXDMXWIFI_HOST_ARDUINO_H
@@ -0,0 +1,37 @@
+/* IPAddress.h
+   host stand-in for building LXDMXWiFi on Linux/POSIX
+   bytes are held in network order, as in the Arduino core
+   see LXDMXWiFi.h for LICENSE
+*/
+
+#ifndef LXDMXWIFI_HOST_IPADDRESS_H
+#define LXDMXWIFI_HOST_IPADDRESS_H
+
+#include <inttypes.h>
+#include <string.h>
+
+class IPAddress {
+  public:
+	IPAddress ( void ) { _address = 0; }
+	IPAddress ( uint32_t address ) { _address = address; }
+	IPAddress ( uint8_t a, uint8_t b, uint8_t c, uint8_t d ) {
+		uint8_t bytes[4] = { a, b, c, d };
+		memcpy(&_address, bytes, 4);
+	}
+
+	operator uint32_t ( void ) const { return _address; }
+	bool operator == ( const IPAddress& other ) const { return _address == other._address; }
+	bool operator != ( const IPAddress& other ) const { return _address != other._address; }
+	bool operator == ( uint32_t other ) const { return _address == other; }
+	bool operator != ( uint32_t other ) const { return _address != other; }
+	uint8_t operator [] ( int index ) const { return ((const uint8_t*)&_address)[index]; }
+	uint8_t& operator [] ( int index ) { return ((uint8_t*)&_address)[index]; }
+
+  private:
+	uint32_t _address;
+};
+
+#define INADDR_NONE IPAddress((uint32_t)0xffffffff)
+#define INADDR_ANY IPAddress((uint32_t)0)
+
+#endif // ifndef LXDMXWIFI_HOST_IPADDRESS_H
@@ -0,0 +1,129 @@
+/* Udp.h
+   host stand-in for building LXDMXWiFi on Linux/POSIX
+   UDP is the subset of the Arduino UDP interface used by the library,
+   WiFiUDP implements it with a POSIX datagram socket
+   see LXDMXWiFi.h for LICENSE
+*/
+
+#ifndef LXDMXWIFI_HOST_UDP_H
+#define LXDMXWIFI_HOST_UDP_H
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include "IPAddress.h"
+
+class UDP {
+  public:
+	virtual ~UDP ( void ) {}
+	virtual uint8_t begin ( uint16_t port ) = 0;
+	virtual void stop ( void ) = 0;
+	virtual int beginPacket ( IPAddress ip, uint16_t port ) = 0;
+	virtual size_t write ( const uint8_t* buffer, size_t size ) = 0;
+	virtual int endPacket ( void ) = 0;
+	virtual int parsePacket ( void ) = 0;
+	virtual int read ( uint8_t* buffer, size_t len ) = 0;
+	virtual IPAddress remoteIP ( void ) = 0;
+	virtual uint16_t remotePort ( void ) = 0;
+};
+
+class WiFiUDP : public UDP {
+  public:
+	WiFiUDP ( void ) : _socket(-1), _out_size(0), _in_size(0), _in_read(0), _remote_port(0) {}
+	~WiFiUDP ( void ) { stop(); }
+
+	uint8_t begin ( uint16_t port ) {
+		stop();
+		_socket = socket(AF_INET, SOCK_DGRAM, 0);
+		if ( _socket < 0 ) {
+			return 0;
+		}
+		int on = 1;
+		setsockopt(_socket, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+		setsockopt(_socket, SOL_SOCKET, SO_BROADCAST, &on, sizeof(on));
+		fcntl(_socket, F_SETFL, O_NONBLOCK);
+		struct sockaddr_in a;
+		memset(&a, 0, sizeof(a));
+		a.sin_family = AF_INET;
+		a.sin_port = htons(port);
+		a.sin_addr.s_addr = htonl(INADDR_ANY);
+		if ( bind(_socket, (struct sockaddr*)&a, sizeof(a)) < 0 ) {
+			stop();
+			return 0;
+		}
+		return 1;
+	}
+
+	void stop ( void ) {
+		if ( _socket >= 0 ) {
+			close(_socket);
+			_socket = -1;
+		}
+	}
+
+	int beginPacket ( IPAddress ip, uint16_t port ) {
+		memset(&_out_address, 0, sizeof(_out_address));
+		_out_address.sin_family = AF_INET;
+		_out_address.sin_port = htons(port);
+		_out_address.sin_addr.s_addr = (uint32_t)ip;
+		_out_size = 0;
+		return ( _socket >= 0 );
+	}
+
+	size_t write ( const uint8_t* buffer, size_t size ) {
+		if ( size > sizeof(_out) - _out_size ) {
+			size = sizeof(_out) - _out_size;
+		}
+		memcpy(&_out[_out_size], buffer, size);
+		_out_size += size;
+		return size;
+	}
+
+	int endPacket ( void ) {
+		return sendto(_socket, _out, _out_size, 0, (struct sockaddr*)&_out_address, sizeof(_out_address)) == (ssize_t)_out_size;
+	}
+
+	int parsePacket ( void ) {
+		struct sockaddr_in a;
+		socklen_t alen = sizeof(a);
+		ssize_t n = recvfrom(_socket, _in, sizeof(_in), 0, (struct sockaddr*)&a, &alen);
+		if ( n <= 0 ) {
+			_in_size = 0;
+			return 0;
+		}
+		_in_size = n;
+		_in_read = 0;
+		_remote_ip = IPAddress((uint32_t)a.sin_addr.s_addr);
+		_remote_port = ntohs(a.sin_port);
+		return n;
+	}
+
+	int read ( uint8_t* buffer, size_t len ) {
+		if ( len > _in_size - _in_read ) {
+			len = _in_size - _in_read;
+		}
+		memcpy(buffer, &_in[_in_read], len);
+		_in_read += len;
+		return len;
+	}
+
+	IPAddress remoteIP ( void ) { return _remote_ip; }
+	uint16_t remotePort ( void ) { return _remote_port; }
+
+  private:
+	int _socket;
+	struct sockaddr_in _out_address;
+	uint8_t _out[1500];
+	size_t _out_size;
+	uint8_t _in[1500];
+	size_t _in_size;
+	size_t _in_read;
+	IPAddress _remote_ip;
+	uint16_t _remote_port;
+};
+
+#endif // ifndef LXDMXWIFI_HOST_UDP_H
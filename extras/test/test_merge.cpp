@@ -0,0 +1,290 @@
+/* test_merge.cpp
+   compares the LXDMXMerge kernels with a slot at a time reference
+   covering every length up to a full universe and unaligned buffers
+   see LXDMXWiFi.h for LICENSE
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "LXDMXWiFiMerge.h"
+
+#define TEST_SIZE 520
+#define TEST_OFFSETS 4
+
+static int failures = 0;
+
+static void fail ( const char* what, uint16_t count, uint16_t total, int offset, int index ) {
+	if ( failures < 20 ) {
+		printf("FAIL %s count %u total %u offset %d index %d\n", what, count, total, offset, index);
+	}
+	failures++;
+}
+
+/*
+  random levels biased toward the ends and 0x7f/0x80 where the SWAR mask changes sign
+*/
+static uint8_t random_level ( void ) {
+	static const uint8_t edges[] = { 0x00, 0x01, 0x7f, 0x80, 0x81, 0xfe, 0xff };
+	int r = rand() % 4;
+	if ( r == 0 ) {
+		return edges[rand() % sizeof(edges)];
+	}
+	return rand() & 0xff;
+}
+
+/*
+  random priority with frequent ties and zero (not sourced)
+*/
+static uint8_t random_priority ( void ) {
+	static const uint8_t levels[] = { 0, 0, 1, 100, 100, 101, 200, 0x80, 0xff };
+	return levels[rand() % sizeof(levels)];
+}
+
+static void fill ( uint8_t* buffer, uint16_t n, uint8_t (*level)(void) ) {
+	for (uint16_t i=0; i<n; i++) {
+		buffer[i] = level();
+	}
+}
+
+static void reset_changes ( LXDMXChanges* changes ) {
+	memset(changes, 0, sizeof(LXDMXChanges));
+	changes->use_bitmap = 1;
+	changes->first = DMX_NO_CHANGE;
+}
+
+/*
+  record the slots that differ between before and after the way the kernels should
+*/
+static void expect_changes ( LXDMXChanges* changes, const uint8_t* before, const uint8_t* after, uint16_t n ) {
+	reset_changes(changes);
+	for (uint16_t i=0; i<n; i++) {
+		if ( before[i] != after[i] ) {
+			if ( i < changes->first ) {
+				changes->first = i;
+			}
+			if ( i > changes->last ) {
+				changes->last = i;
+			}
+			changes->bitmap[i >> 3] |= (1 << (i & 7));
+		}
+	}
+}
+
+static void compare_buffers ( const char* what, const uint8_t* a, const uint8_t* b, uint16_t n,
+                              uint16_t count, uint16_t total, int offset ) {
+	for (uint16_t i=0; i<n; i++) {
+		if ( a[i] != b[i] ) {
+			fail(what, count, total, offset, i);
+			return;
+		}
+	}
+}
+
+static void compare_changes ( const char* what, const LXDMXChanges* a, const LXDMXChanges* b,
+                              uint16_t count, uint16_t total, int offset ) {
+	if ( ( a->first != b->first ) || ( a->last != b->last ) ||
+	     memcmp(a->bitmap, b->bitmap, DMX_CHANGE_BITMAP_SIZE) ) {
+		fail(what, count, total, offset, -1);
+	}
+}
+
+static void test_merge_htp ( uint16_t count, uint16_t total, int offset ) {
+	uint8_t data_b[TEST_SIZE + TEST_OFFSETS];
+	uint8_t other_b[TEST_SIZE + TEST_OFFSETS];
+	uint8_t source_b[TEST_SIZE + TEST_OFFSETS];
+	uint8_t merged_b[TEST_SIZE + TEST_OFFSETS];
+	uint8_t* data = &data_b[offset];
+	uint8_t* other = &other_b[(offset + 1) % TEST_OFFSETS];
+	uint8_t* source = &source_b[(offset + 2) % TEST_OFFSETS];
+	uint8_t* merged = &merged_b[(offset + 3) % TEST_OFFSETS];
+	uint8_t ref_source[TEST_SIZE];
+	uint8_t ref_merged[TEST_SIZE];
+	LXDMXChanges changes;
+	LXDMXChanges ref_changes;
+
+	fill(data, count, random_level);
+	fill(other, total, random_level);
+	fill(source, total, random_level);
+	fill(merged, total, random_level);
+	if ( rand() & 1 ) {					// mostly unchanged, as for a repeated packet
+		for (uint16_t i=0; i<count; i++) {
+			merged[i] = ( data[i] > other[i] ) ? data[i] : other[i];
+		}
+		merged[rand() % total] ^= 0x80;
+	}
+
+	for (uint16_t i=0; i<total; i++) {
+		ref_source[i] = ( i < count ) ? data[i] : 0;
+		ref_merged[i] = ( ref_source[i] > other[i] ) ? ref_source[i] : other[i];
+	}
+	expect_changes(&ref_changes, merged, ref_merged, total);
+
+	reset_changes(&changes);
+	LXDMXMerge::mergeHTP(source, data, count, other, merged, total, &changes);
+	compare_buffers("mergeHTP source", source, ref_source, total, count, total, offset);
+	compare_buffers("mergeHTP merged", merged, ref_merged, total, count, total, offset);
+	compare_changes("mergeHTP changes", &changes, &ref_changes, count, total, offset);
+
+	fill(merged, total, random_level);
+	LXDMXMerge::mergeHTP(source, data, count, other, merged, total, NULL);
+	compare_buffers("mergeHTP merged (no changes)", merged, ref_merged, total, count, total, offset);
+}
+
+static void test_merge_priority ( uint16_t count, uint16_t total, int offset ) {
+	uint8_t data_b[TEST_SIZE + TEST_OFFSETS];
+	uint8_t other_b[TEST_SIZE + TEST_OFFSETS];
+	uint8_t priority_b[TEST_SIZE + TEST_OFFSETS];
+	uint8_t other_priority_b[TEST_SIZE + TEST_OFFSETS];
+	uint8_t source_b[TEST_SIZE + TEST_OFFSETS];
+	uint8_t merged_b[TEST_SIZE + TEST_OFFSETS];
+	uint8_t* data = &data_b[offset];
+	uint8_t* other = &other_b[(offset + 1) % TEST_OFFSETS];
+	uint8_t* priority = &priority_b[(offset + 2) % TEST_OFFSETS];
+	uint8_t* other_priority = &other_priority_b[(offset + 3) % TEST_OFFSETS];
+	uint8_t* source = &source_b[(offset + 1) % TEST_OFFSETS];
+	uint8_t* merged = &merged_b[(offset + 2) % TEST_OFFSETS];
+	uint8_t ref_source[TEST_SIZE];
+	uint8_t ref_merged[TEST_SIZE];
+	LXDMXChanges changes;
+	LXDMXChanges ref_changes;
+
+	fill(data, count, random_level);
+	fill(other, total, random_level);
+	fill(priority, total, random_priority);
+	fill(other_priority, total, random_priority);
+	fill(source, total, random_level);
+	fill(merged, total, random_level);
+
+	for (uint16_t i=0; i<total; i++) {
+		uint8_t p = ( i < count ) ? priority[i] : 0;
+		ref_source[i] = ( i < count ) ? data[i] : 0;
+		if ( p > other_priority[i] ) {
+			ref_merged[i] = ref_source[i];
+		} else if ( other_priority[i] > p ) {
+			ref_merged[i] = other[i];
+		} else if ( p ) {
+			ref_merged[i] = ( ref_source[i] > other[i] ) ? ref_source[i] : other[i];
+		} else {
+			ref_merged[i] = 0;
+		}
+	}
+	expect_changes(&ref_changes, merged, ref_merged, total);
+
+	reset_changes(&changes);
+	LXDMXMerge::mergePriorityHTP(source, data, count, priority, other, other_priority, merged, total, &changes);
+	compare_buffers("mergePriorityHTP source", source, ref_source, total, count, total, offset);
+	compare_buffers("mergePriorityHTP merged", merged, ref_merged, total, count, total, offset);
+	compare_changes("mergePriorityHTP changes", &changes, &ref_changes, count, total, offset);
+}
+
+static void test_merge_slots ( uint16_t count, int offset ) {
+	uint8_t a_b[TEST_SIZE + TEST_OFFSETS];
+	uint8_t b_b[TEST_SIZE + TEST_OFFSETS];
+	uint8_t* a = &a_b[offset];
+	uint8_t* b = &b_b[(offset + 1) % TEST_OFFSETS];
+	uint8_t ref_merged[TEST_SIZE];
+	LXDMXChanges changes;
+	LXDMXChanges ref_changes;
+
+	fill(a, count, random_level);
+	fill(b, count, random_level);
+	for (uint16_t i=0; i<count; i++) {
+		ref_merged[i] = ( a[i] > b[i] ) ? a[i] : b[i];
+	}
+	expect_changes(&ref_changes, b, ref_merged, count);
+
+	// accumulate in place, merged is the same buffer as b
+	reset_changes(&changes);
+	LXDMXMerge::mergeSlots(a, b, b, count, &changes);
+	compare_buffers("mergeSlots merged", b, ref_merged, count, count, count, offset);
+	compare_changes("mergeSlots changes", &changes, &ref_changes, count, count, offset);
+}
+
+static void test_copy_slots ( uint16_t count, uint16_t total, int offset ) {
+	uint8_t data_b[TEST_SIZE + TEST_OFFSETS];
+	uint8_t dest_b[TEST_SIZE + TEST_OFFSETS];
+	uint8_t* data = &data_b[offset];
+	uint8_t* dest = &dest_b[(offset + 3) % TEST_OFFSETS];
+	uint8_t ref_dest[TEST_SIZE];
+	LXDMXChanges changes;
+	LXDMXChanges ref_changes;
+
+	fill(data, count, random_level);
+	fill(dest, total, random_level);
+	if ( rand() & 1 ) {
+		memcpy(dest, data, count);
+		memset(&dest[count], 0, total - count);
+		dest[rand() % total] ^= 0x01;
+	}
+	for (uint16_t i=0; i<total; i++) {
+		ref_dest[i] = ( i < count ) ? data[i] : 0;
+	}
+	expect_changes(&ref_changes, dest, ref_dest, total);
+
+	reset_changes(&changes);
+	LXDMXMerge::copySlots(dest, data, count, total, &changes);
+	compare_buffers("copySlots dest", dest, ref_dest, total, count, total, offset);
+	compare_changes("copySlots changes", &changes, &ref_changes, count, total, offset);
+}
+
+static void test_add_changes ( void ) {
+	LXDMXChanges changes;
+	LXDMXChanges ref_changes;
+
+	for (int n=0; n<1000; n++) {
+		reset_changes(&changes);
+		reset_changes(&ref_changes);
+		int ranges = 1 + rand() % 4;
+		for (int r=0; r<ranges; r++) {
+			uint16_t first = rand() % TEST_SIZE;
+			uint16_t last = rand() % TEST_SIZE;
+			if ( first > last ) {			// reversed ranges are ignored
+				LXDMXMerge::addChanges(&changes, first, last);
+				continue;
+			}
+			LXDMXMerge::addChanges(&changes, first, last);
+			for (uint16_t k=first; k<=last; k++) {
+				if ( k < ref_changes.first ) {
+					ref_changes.first = k;
+				}
+				if ( k > ref_changes.last ) {
+					ref_changes.last = k;
+				}
+				ref_changes.bitmap[k >> 3] |= (1 << (k & 7));
+			}
+		}
+		compare_changes("addChanges", &changes, &ref_changes, ranges, 0, 0);
+
+		// clearChanges must leave an empty record and bitmap
+		LXDMXMerge::clearChanges(&changes);
+		reset_changes(&ref_changes);
+		ref_changes.last = changes.last;
+		compare_changes("clearChanges", &changes, &ref_changes, ranges, 0, 0);
+	}
+}
+
+int main ( void ) {
+	srand(512);
+
+	for (uint16_t total=1; total<=TEST_SIZE; total++) {
+		for (int offset=0; offset<TEST_OFFSETS; offset++) {
+			uint16_t count = total - ( rand() % ( total < 40 ? total : 40 ) );	// short packets
+			test_merge_htp(total, total, offset);
+			test_merge_htp(count, total, offset);
+			test_merge_priority(total, total, offset);
+			test_merge_priority(count, total, offset);
+			test_merge_slots(total, offset);
+			test_copy_slots(total, total, offset);
+			test_copy_slots(count, total, offset);
+		}
+	}
+	test_add_changes();
+
+	if ( failures ) {
+		printf("%d failures\n", failures);
+		return 1;
+	}
+	printf("merge kernels match reference\n");
+	return 0;
+}
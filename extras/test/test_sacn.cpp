@@ -0,0 +1,197 @@
+/* test_sacn.cpp
+   receives E1.31 packets from several senders and checks how they are merged
+   by packet priority and per-address priority (0xDD)
+   see LXDMXWiFi.h for LICENSE
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "LXWiFiSACN.h"
+
+#define TEST_SLOTS 8
+
+static int failures = 0;
+
+/*
+  UDP that reads back the last packet written to it
+*/
+class LoopbackUDP : public UDP {
+  public:
+	LoopbackUDP ( void ) : _size(0), _available(0) {}
+	uint8_t begin ( uint16_t ) { return 1; }
+	void stop ( void ) {}
+	int beginPacket ( IPAddress, uint16_t ) { _size = 0; _available = 0; return 1; }
+	size_t write ( const uint8_t* buffer, size_t size ) {
+		if ( size > sizeof(_packet) - _size ) {
+			size = sizeof(_packet) - _size;
+		}
+		memcpy(&_packet[_size], buffer, size);
+		_size += size;
+		return size;
+	}
+	int endPacket ( void ) { _available = 1; return 1; }
+	int parsePacket ( void ) { return _available ? _size : 0; }
+	int read ( uint8_t* buffer, size_t len ) {
+		if ( len > _size ) {
+			len = _size;
+		}
+		memcpy(buffer, _packet, len);
+		_available = 0;
+		return len;
+	}
+	IPAddress remoteIP ( void ) { return IPAddress(10,0,0,1); }
+	uint16_t remotePort ( void ) { return SACN_PORT; }
+
+  private:
+	uint8_t _packet[700];
+	size_t _size;
+	uint8_t _available;
+};
+
+/*
+  a console sending levels and per-address priority on universe 1
+*/
+class Console {
+  public:
+	Console ( uint8_t id, uint8_t priority ) {
+		uint8_t cid[SACN_CID_LENGTH];
+		memset(cid, id, SACN_CID_LENGTH);
+		_sender.setCID(cid);
+		_sender.setPriority(priority);
+		_sender.setUniverse(1);
+		_sender.setNumberOfSlots(TEST_SLOTS);
+	}
+
+	uint8_t send ( LXWiFiSACN* receiver, uint8_t start_code, const uint8_t* values ) {
+		LoopbackUDP udp;
+		_sender.setStartCode(start_code);
+		for (int i=0; i<TEST_SLOTS; i++) {
+			_sender.setSlot(i+1, values[i]);
+		}
+		_sender.sendDMX(&udp, IPAddress(239,255,0,1), INADDR_ANY);
+		return receiver->readDMXPacket(&udp);
+	}
+
+  private:
+	LXWiFiSACN _sender;
+};
+
+static void expect ( const char* what, LXWiFiSACN* receiver, const uint8_t* levels ) {
+	for (int i=0; i<TEST_SLOTS; i++) {
+		if ( receiver->getSlot(i+1) != levels[i] ) {
+			printf("FAIL %s slot %d is %d, expected %d\n", what, i+1, receiver->getSlot(i+1), levels[i]);
+			failures++;
+			return;
+		}
+	}
+}
+
+static void expect_result ( const char* what, uint8_t result, uint8_t expected ) {
+	if ( result != expected ) {
+		printf("FAIL %s result %d, expected %d\n", what, result, expected);
+		failures++;
+	}
+}
+
+/*
+  a higher packet priority does not replace a sender whose 0xDD slots are higher,
+  each slot goes to the sender with the higher slot priority
+*/
+static void test_higher_packet_priority ( void ) {
+	LXWiFiSACN receiver;
+	Console a(1, 100);
+	Console b(2, 120);
+	static const uint8_t levels_a[] = { 10, 10, 10, 10, 10, 10, 10, 10 };
+	static const uint8_t levels_b[] = { 20, 20, 20, 20, 20, 20, 20, 20 };
+	static const uint8_t priority_a[] = { 150, 150, 150, 150, 50, 50, 50, 50 };
+	static const uint8_t priority_b[] = { 50, 150, 50, 150, 150, 50, 150, 50 };
+
+	a.send(&receiver, 0, levels_a);
+	a.send(&receiver, SACN_PRIORITY_START_CODE, priority_a);
+	expect_result("a levels", a.send(&receiver, 0, levels_a), RESULT_DMX_RECEIVED);
+
+	// b's packet priority 120 fills its slots until its 0xDD is received
+	expect_result("b levels", b.send(&receiver, 0, levels_b), RESULT_DMX_RECEIVED);
+	static const uint8_t packet_priority[] = { 10, 10, 10, 10, 20, 20, 20, 20 };
+	expect("b by packet priority", &receiver, packet_priority);
+
+	// interleaved ownership, equal slot priority is HTP
+	b.send(&receiver, SACN_PRIORITY_START_CODE, priority_b);
+	expect_result("b levels after 0xDD", b.send(&receiver, 0, levels_b), RESULT_DMX_RECEIVED);
+	static const uint8_t interleaved[] = { 10, 20, 10, 20, 20, 20, 20, 20 };
+	expect("interleaved", &receiver, interleaved);
+
+	expect_result("a levels after b", a.send(&receiver, 0, levels_a), RESULT_DMX_RECEIVED);
+	expect("interleaved after a", &receiver, interleaved);
+}
+
+/*
+  a sender with a lower packet priority is accepted once it sends 0xDD
+*/
+static void test_lower_packet_priority ( void ) {
+	LXWiFiSACN receiver;
+	Console a(1, 100);
+	Console b(2, 80);
+	static const uint8_t levels_a[] = { 10, 10, 10, 10, 10, 10, 10, 10 };
+	static const uint8_t levels_b[] = { 30, 30, 30, 30, 30, 30, 30, 30 };
+	static const uint8_t priority_b[] = { 190, 190, 0, 0, 190, 0, 0, 0 };
+
+	a.send(&receiver, 0, levels_a);
+	expect_result("b before 0xDD", b.send(&receiver, 0, levels_b), RESULT_NONE);
+	expect("a alone", &receiver, levels_a);
+
+	b.send(&receiver, SACN_PRIORITY_START_CODE, priority_b);
+	expect_result("b after 0xDD", b.send(&receiver, 0, levels_b), RESULT_DMX_RECEIVED);
+	static const uint8_t owned[] = { 30, 30, 10, 10, 30, 10, 10, 10 };
+	expect("b owns its 0xDD slots", &receiver, owned);
+
+	// a third sender below b's highest slot is not merged
+	Console c(3, 150);
+	static const uint8_t levels_c[] = { 40, 40, 40, 40, 40, 40, 40, 40 };
+	expect_result("c below 0xDD", c.send(&receiver, 0, levels_c), RESULT_NONE);
+	expect("c ignored", &receiver, owned);
+
+	// one above every slot replaces both
+	Console d(4, 200);
+	static const uint8_t levels_d[] = { 50, 50, 50, 50, 50, 50, 50, 50 };
+	expect_result("d above all", d.send(&receiver, 0, levels_d), RESULT_DMX_RECEIVED);
+	expect("d replaces a and b", &receiver, levels_d);
+	expect_result("a after d", a.send(&receiver, 0, levels_a), RESULT_NONE);
+	expect("a ignored", &receiver, levels_d);
+}
+
+/*
+  without 0xDD a higher packet priority takes over and a lower one is ignored
+*/
+static void test_packet_priority ( void ) {
+	LXWiFiSACN receiver;
+	Console a(1, 100);
+	Console b(2, 100);
+	Console c(3, 120);
+	static const uint8_t levels_a[] = { 10, 60, 10, 60, 10, 60, 10, 60 };
+	static const uint8_t levels_b[] = { 30, 30, 30, 30, 30, 30, 30, 30 };
+	static const uint8_t levels_c[] = { 5, 5, 5, 5, 5, 5, 5, 5 };
+
+	a.send(&receiver, 0, levels_a);
+	expect_result("b equal", b.send(&receiver, 0, levels_b), RESULT_DMX_RECEIVED);
+	static const uint8_t htp[] = { 30, 60, 30, 60, 30, 60, 30, 60 };
+	expect("HTP", &receiver, htp);
+
+	expect_result("c higher", c.send(&receiver, 0, levels_c), RESULT_DMX_RECEIVED);
+	expect("c replaces a and b", &receiver, levels_c);
+	expect_result("a lower", a.send(&receiver, 0, levels_a), RESULT_NONE);
+	expect("a ignored", &receiver, levels_c);
+}
+
+int main ( void ) {
+	test_higher_packet_priority();
+	test_lower_packet_priority();
+	test_packet_priority();
+
+	if ( failures ) {
+		printf("%d failures\n", failures);
+		return 1;
+	}
+	printf("sACN receive merge as expected\n");
+	return 0;
+}
@@ -42,6 +42,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #endif
 
 #define DMX_UNIVERSE_SIZE 512
+#define DMX_MIN_SEND_INTERVAL 23
 
 #define RESULT_NONE 0
 #define RESULT_DMX_RECEIVED 1
@@ -65,9 +66,14 @@ class LXDMXWiFi {
 
   public:
 /*!
+* @brief virtual so that subclasses are destroyed through LXDMXWiFi*
+*/
+   virtual ~LXDMXWiFi ( void ) {}
+
+/*!
 * @brief UDP port used by protocol
 */
-   virtual uint16_t dmxPort      ( void );
+   virtual uint16_t dmxPort      ( void ) = 0;
 
 /*!
 * @brief universe for sending and receiving dmx
@@ -76,7 +82,7 @@ class LXDMXWiFi {
 * sACN is a full 16 bit but limited to the range 1-63999
 * @return universe 0/1-255
 */
-   virtual uint16_t universe      ( void );
+   virtual uint16_t universe      ( void ) = 0;
 /*!
 * @brief set universe for sending and receiving
 * @discussion First universe is zero for Art-Net and one for sACN E1.31.
@@ -86,49 +92,80 @@ class LXDMXWiFi {
 * With sACN, setUniverse(0x12) is universe 18.
 * @param u universe 0/1-255
 */
-   virtual void    setUniverse   ( uint16_t u );
+   virtual void    setUniverse   ( uint16_t u ) = 0;
  
  /*!
  * @brief number of slots (aka addresses or channels)
  * @discussion Should be minimum of ~24 depending on actual output speed.  Max of 512.
  * @return number of slots/addresses/channels
  */  
-   virtual int  numberOfSlots    ( void );
+   virtual int  numberOfSlots    ( void ) = 0;
  /*!
  * @brief set number of slots (aka addresses or channels)
  * @discussion Should be minimum of ~24 depending on actual output speed.  Max of 512.
  * @param n 1 to 512
  */  
-   virtual void setNumberOfSlots ( int n );
+   virtual void setNumberOfSlots ( int n ) = 0;
  /*!
  * @brief get level data from slot/address/channel
  * @param slot 1 to 512
  * @return level for slot (0-255)
  */  
-   virtual uint8_t  getSlot      ( int slot );
+   virtual uint8_t  getSlot      ( int slot ) = 0;
  /*!
  * @brief set level data (0-255) for slot/address/channel
  * @param slot 1 to 512
  * @param level 0 to 255
  */  
-   virtual void     setSlot      ( int slot, uint8_t level );
+   virtual void     setSlot      ( int slot, uint8_t level ) = 0;
  /*!
  * @brief direct pointer to dmx buffer uint8_t[]
+ * @discussion The first call keeps a copy of the levels so that sendDMXOnChange
+ *             can find changes written directly to the buffer.
  * @return uint8_t* to dmx data buffer
  */  
-   virtual uint8_t* dmxData      ( void );
+   virtual uint8_t* dmxData      ( void ) = 0;
+
+ /*!
+ * @brief first slot changed by the last dmx packet read
+ * @return slot 1 to 512 or 0 if no slots changed
+ */
+   virtual uint16_t changedSlotsFirst ( void ) = 0;
+ /*!
+ * @brief last slot changed by the last dmx packet read
+ * @return slot 1 to 512 or 0 if no slots changed
+ */
+   virtual uint16_t changedSlotsLast  ( void ) = 0;
+ /*!
+ * @brief test if a slot was changed by the last dmx packet read
+ * @discussion Without the bitmap, every slot from changedSlotsFirst() to changedSlotsLast() is reported.
+ * @param slot 1 to 512
+ * @return 1 if slot changed
+ */
+   virtual uint8_t  slotChanged       ( int slot ) = 0;
+ /*!
+ * @brief enable per-slot change bitmap
+ * @discussion The bitmap costs a little time on each changed slot and is off by default.
+ * @param en 1 to maintain bitmap
+ */
+   virtual void     setChangedSlotBitmap ( uint8_t en ) = 0;
+ /*!
+ * @brief direct pointer to changed slot bitmap
+ * @return uint8_t[64], bit (n-1)&7 of byte (n-1)>>3 is set if slot n changed
+ */
+   virtual uint8_t* changedSlotBitmap ( void ) = 0;
    
  /*!
  * @brief direct pointer to packet buffer uint8_t[]
  * @return uint8_t* to packet buffer
  */ 
-   virtual uint8_t* packetBuffer      ( void );
+   virtual uint8_t* packetBuffer      ( void ) = 0;
 
 /*!
  * @brief size of last packet received with readDMXPacket
  * @return uint16_t last packet size
  */ 
-   virtual uint16_t packetSize      ( void );
+   virtual uint16_t packetSize      ( void ) = 0;
 
  /*!
  * @brief read UDP packet
@@ -136,7 +173,7 @@ class LXDMXWiFi {
  * @param wUDP pointer to UDP object
  * @return 1 if packet contains dmx
  */   
-   virtual uint8_t readDMXPacket ( UDP* pUDP );
+   virtual uint8_t readDMXPacket ( UDP* pUDP ) = 0;
    
  /*!
  * @brief read contents of packet from _packet_buffer
@@ -146,7 +183,7 @@ class LXDMXWiFi {
  * @param packetSize size of received packet
  * @return 1 if packet contains dmx
  */      
-   virtual uint8_t readDMXPacketContents ( UDP* wUDP, uint16_t packetSize );
+   virtual uint8_t readDMXPacketContents ( UDP* wUDP, uint16_t packetSize ) = 0;
    
  /*!
  * @brief send packet for dmx output from network
@@ -154,7 +191,25 @@ class LXDMXWiFi {
  * @param to_ip target address
  * @param interfaceAddr != 0 for multicast
  */  
-   virtual void    sendDMX       ( UDP* wUDP, IPAddress to_ip, IPAddress interfaceAddr );
+   virtual void    sendDMX       ( UDP* wUDP, IPAddress to_ip, IPAddress interfaceAddr ) = 0;
+
+ /*!
+ * @brief send packet for dmx output only if levels have changed or a refresh is due
+ * @discussion Call as often as desired.  A change made with setSlot or setNumberOfSlots is sent
+ *             as soon as the minimum send interval allows.  Otherwise, packets are only sent at
+ *             the refresh rate of the protocol.  Levels written through dmxData() are compared
+ *             with the last packet sent.
+ * @param wUDP UDP* object to be used for sending UDP packet
+ * @param to_ip target address
+ * @param interfaceAddr != 0 for multicast
+ * @return 1 if a packet was sent
+ */
+   virtual uint8_t sendDMXOnChange ( UDP* wUDP, IPAddress to_ip, IPAddress interfaceAddr ) = 0;
+ /*!
+ * @brief minimum time between packets sent by sendDMXOnChange
+ * @param ms milliseconds (default DMX_MIN_SEND_INTERVAL, about one DMX frame at full rate)
+ */
+   virtual void    setMinimumSendInterval ( uint16_t ms ) = 0;
 };
 
 
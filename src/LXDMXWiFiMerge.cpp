@@ -0,0 +1,374 @@
+/**************************************************************************/
+/*!
+    @file     LXDMXWiFiMerge.cpp
+    @author   Claude Heintz
+    @license  BSD (see LXDMXWiFi.h)
+    @copyright 2026 by Claude Heintz All Rights Reserved
+
+    HTP merge kernels shared by LXWiFiArtNet and LXWiFiSACN.
+
+    @section  HISTORY
+
+    v1.0 - First release
+    v1.1 - adds changed slot record
+    v1.2 - adds mergeSlots for more than two sources
+    v1.3 - adds mergePriorityHTP for per-address priority
+*/
+/**************************************************************************/
+
+#include "LXDMXWiFiMerge.h"
+#include <string.h>
+#include <stdint.h>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+	#define _LXDMX_MERGE_VECTOR 16
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define _LXDMX_MERGE_VECTOR 16
+#endif
+
+/*
+  SWAR word: 64 bit where pointers are 64 bit, otherwise 32 bit (ESP8266, ESP32, SAMD)
+*/
+#if UINTPTR_MAX > 0xffffffffUL
+	typedef uint64_t lxdmx_word_t;
+	#define _LXDMX_HIGH_BITS 0x8080808080808080ULL
+	#define _LXDMX_LOW_BITS 0x0101010101010101ULL
+#else
+	typedef uint32_t lxdmx_word_t;
+	#define _LXDMX_HIGH_BITS 0x80808080UL
+	#define _LXDMX_LOW_BITS 0x01010101UL
+#endif
+
+/*
+  byte-wise unsigned a >= b as a 0xff/0x00 byte mask
+
+  x has the high bit of each byte set where the low 7 bits of a >= the low 7 bits of b
+  (the subtraction cannot borrow across bytes because the high bit of a is forced on)
+  a >= b where the high bit of a is set and b's is not,
+      or the high bits are equal and the low 7 bits of a >= b
+  the high bit of each byte is then spread to a full 0xff/0x00 byte mask
+*/
+static inline lxdmx_word_t lxdmx_ge_mask ( lxdmx_word_t a, lxdmx_word_t b ) {
+	lxdmx_word_t x = (a | _LXDMX_HIGH_BITS) - (b & ~_LXDMX_HIGH_BITS);
+	lxdmx_word_t ge = ((a & ~b) | (~(a ^ b) & x)) & _LXDMX_HIGH_BITS;
+	return (ge >> 7) * 0xff;
+}
+
+/*
+  byte-wise unsigned maximum of two words
+*/
+static inline lxdmx_word_t lxdmx_max_word ( lxdmx_word_t a, lxdmx_word_t b ) {
+	lxdmx_word_t mask = lxdmx_ge_mask(a, b);
+	return (a & mask) | (b & ~mask);
+}
+
+/*
+  record each byte of n that differs between old_bytes and new_bytes
+  index is the buffer index of old_bytes[0]
+*/
+static void lxdmx_record_changes ( LXDMXChanges* changes, const uint8_t* old_bytes,
+                                   const uint8_t* new_bytes, uint16_t index, uint16_t n ) {
+	for (uint16_t k=0; k<n; k++) {
+		if ( old_bytes[k] != new_bytes[k] ) {
+			uint16_t slot = index + k;
+			if ( slot < changes->first ) {		// DMX_NO_CHANGE is greater than any slot
+				changes->first = slot;
+			}
+			if ( slot > changes->last ) {
+				changes->last = slot;
+			}
+			if ( changes->use_bitmap ) {
+				changes->bitmap[slot >> 3] |= (1 << (slot & 7));
+			}
+		}
+	}
+}
+
+/*
+  dest[0..n) = src[0..n) or zero if src is NULL, recording changes in dest
+*/
+static void lxdmx_copy ( uint8_t* dest, const uint8_t* src, uint16_t n, uint16_t index, LXDMXChanges* changes ) {
+	if ( changes == NULL ) {
+		if ( src ) {
+			memcpy(dest, src, n);
+		} else {
+			memset(dest, 0, n);
+		}
+		return;
+	}
+	uint16_t i = 0;
+	lxdmx_word_t s = 0;
+	for ( ; i + sizeof(lxdmx_word_t) <= n; i += sizeof(lxdmx_word_t) ) {
+		lxdmx_word_t d;
+		memcpy(&d, &dest[i], sizeof(lxdmx_word_t));
+		if ( src ) {
+			memcpy(&s, &src[i], sizeof(lxdmx_word_t));
+		}
+		if ( d != s ) {
+			lxdmx_record_changes(changes, &dest[i], (const uint8_t*)&s, index + i, sizeof(lxdmx_word_t));
+			memcpy(&dest[i], &s, sizeof(lxdmx_word_t));
+		}
+	}
+	for ( ; i < n; i++ ) {
+		uint8_t b = src ? src[i] : 0;
+		if ( dest[i] != b ) {
+			lxdmx_record_changes(changes, &dest[i], &b, index + i, 1);
+			dest[i] = b;
+		}
+	}
+}
+
+/*
+  merged[0..count) = max(data, other), recording changes in merged
+  if source is not NULL, source[0..count) = data
+  merged may be the same buffer as data or other (each step loads before it stores)
+*/
+static void lxdmx_merge ( uint8_t* source, const uint8_t* data, const uint8_t* other,
+                          uint8_t* merged, uint16_t count, LXDMXChanges* changes ) {
+	uint16_t i = 0;
+
+#if defined(_LXDMX_MERGE_VECTOR)
+	uint8_t v[_LXDMX_MERGE_VECTOR];
+	for ( ; i + _LXDMX_MERGE_VECTOR <= count; i += _LXDMX_MERGE_VECTOR ) {
+	#if defined(__SSE2__)
+		__m128i d = _mm_loadu_si128((const __m128i*)&data[i]);
+		__m128i o = _mm_loadu_si128((const __m128i*)&other[i]);
+		__m128i m = _mm_max_epu8(d, o);
+		if ( source ) {
+			_mm_storeu_si128((__m128i*)&source[i], d);
+		}
+		if ( changes ) {
+			__m128i p = _mm_loadu_si128((const __m128i*)&merged[i]);
+			if ( _mm_movemask_epi8(_mm_cmpeq_epi8(p, m)) != 0xffff ) {
+				_mm_storeu_si128((__m128i*)v, m);
+				lxdmx_record_changes(changes, &merged[i], v, i, _LXDMX_MERGE_VECTOR);
+			}
+		}
+		_mm_storeu_si128((__m128i*)&merged[i], m);
+	#else
+		uint8x16_t d = vld1q_u8(&data[i]);
+		uint8x16_t o = vld1q_u8(&other[i]);
+		uint8x16_t m = vmaxq_u8(d, o);
+		if ( source ) {
+			vst1q_u8(&source[i], d);
+		}
+		if ( changes ) {
+			uint64x2_t x = vreinterpretq_u64_u8(veorq_u8(vld1q_u8(&merged[i]), m));
+			if ( vgetq_lane_u64(x, 0) | vgetq_lane_u64(x, 1) ) {
+				vst1q_u8(v, m);
+				lxdmx_record_changes(changes, &merged[i], v, i, _LXDMX_MERGE_VECTOR);
+			}
+		}
+		vst1q_u8(&merged[i], m);
+	#endif
+	}
+#endif
+
+	// memcpy is used for loads and stores because packet data is not word aligned
+	for ( ; i + sizeof(lxdmx_word_t) <= count; i += sizeof(lxdmx_word_t) ) {
+		lxdmx_word_t d;
+		lxdmx_word_t o;
+		memcpy(&d, &data[i], sizeof(lxdmx_word_t));
+		memcpy(&o, &other[i], sizeof(lxdmx_word_t));
+		if ( source ) {
+			memcpy(&source[i], &d, sizeof(lxdmx_word_t));
+		}
+		d = lxdmx_max_word(d, o);
+		if ( changes ) {
+			memcpy(&o, &merged[i], sizeof(lxdmx_word_t));
+			if ( o != d ) {
+				lxdmx_record_changes(changes, &merged[i], (const uint8_t*)&d, i, sizeof(lxdmx_word_t));
+			}
+		}
+		memcpy(&merged[i], &d, sizeof(lxdmx_word_t));
+	}
+
+	for ( ; i < count; i++ ) {
+		uint8_t d = data[i];
+		uint8_t m = ( d > other[i] ) ? d : other[i];
+		if ( source ) {
+			source[i] = d;
+		}
+		if ( changes && ( merged[i] != m ) ) {
+			lxdmx_record_changes(changes, &merged[i], &m, i, 1);
+		}
+		merged[i] = m;
+	}
+}
+
+/*
+  merged[0..count) = level of data or other with the higher priority, max of the two if
+  the priorities are equal and not 0, recording changes in merged
+  source[0..count) = data
+*/
+static void lxdmx_merge_priority ( uint8_t* source, const uint8_t* data, const uint8_t* priority,
+                                   const uint8_t* other, const uint8_t* other_priority,
+                                   uint8_t* merged, uint16_t count, LXDMXChanges* changes ) {
+	uint16_t i = 0;
+
+#if defined(_LXDMX_MERGE_VECTOR)
+	uint8_t v[_LXDMX_MERGE_VECTOR];
+	for ( ; i + _LXDMX_MERGE_VECTOR <= count; i += _LXDMX_MERGE_VECTOR ) {
+	#if defined(__SSE2__)
+		__m128i d = _mm_loadu_si128((const __m128i*)&data[i]);
+		__m128i o = _mm_loadu_si128((const __m128i*)&other[i]);
+		__m128i p = _mm_loadu_si128((const __m128i*)&priority[i]);
+		__m128i q = _mm_loadu_si128((const __m128i*)&other_priority[i]);
+		__m128i pq = _mm_max_epu8(p, q);
+		__m128i p_ge = _mm_cmpeq_epi8(pq, p);
+		__m128i q_ge = _mm_cmpeq_epi8(pq, q);
+		__m128i tie = _mm_andnot_si128(_mm_cmpeq_epi8(p, _mm_setzero_si128()), _mm_and_si128(p_ge, q_ge));
+		__m128i m = _mm_or_si128(_mm_or_si128(_mm_and_si128(d, _mm_andnot_si128(q_ge, p_ge)),
+		                                      _mm_and_si128(o, _mm_andnot_si128(p_ge, q_ge))),
+		                         _mm_and_si128(_mm_max_epu8(d, o), tie));
+		_mm_storeu_si128((__m128i*)&source[i], d);
+		if ( changes ) {
+			__m128i x = _mm_loadu_si128((const __m128i*)&merged[i]);
+			if ( _mm_movemask_epi8(_mm_cmpeq_epi8(x, m)) != 0xffff ) {
+				_mm_storeu_si128((__m128i*)v, m);
+				lxdmx_record_changes(changes, &merged[i], v, i, _LXDMX_MERGE_VECTOR);
+			}
+		}
+		_mm_storeu_si128((__m128i*)&merged[i], m);
+	#else
+		uint8x16_t d = vld1q_u8(&data[i]);
+		uint8x16_t o = vld1q_u8(&other[i]);
+		uint8x16_t p = vld1q_u8(&priority[i]);
+		uint8x16_t q = vld1q_u8(&other_priority[i]);
+		uint8x16_t p_ge = vcgeq_u8(p, q);
+		uint8x16_t q_ge = vcgeq_u8(q, p);
+		uint8x16_t tie = vandq_u8(vandq_u8(p_ge, q_ge), vtstq_u8(p, p));
+		uint8x16_t m = vorrq_u8(vorrq_u8(vandq_u8(d, vbicq_u8(p_ge, q_ge)),
+		                                 vandq_u8(o, vbicq_u8(q_ge, p_ge))),
+		                        vandq_u8(vmaxq_u8(d, o), tie));
+		vst1q_u8(&source[i], d);
+		if ( changes ) {
+			uint64x2_t x = vreinterpretq_u64_u8(veorq_u8(vld1q_u8(&merged[i]), m));
+			if ( vgetq_lane_u64(x, 0) | vgetq_lane_u64(x, 1) ) {
+				vst1q_u8(v, m);
+				lxdmx_record_changes(changes, &merged[i], v, i, _LXDMX_MERGE_VECTOR);
+			}
+		}
+		vst1q_u8(&merged[i], m);
+	#endif
+	}
+#endif
+
+	for ( ; i + sizeof(lxdmx_word_t) <= count; i += sizeof(lxdmx_word_t) ) {
+		lxdmx_word_t d;
+		lxdmx_word_t o;
+		lxdmx_word_t p;
+		lxdmx_word_t q;
+		memcpy(&d, &data[i], sizeof(lxdmx_word_t));
+		memcpy(&o, &other[i], sizeof(lxdmx_word_t));
+		memcpy(&p, &priority[i], sizeof(lxdmx_word_t));
+		memcpy(&q, &other_priority[i], sizeof(lxdmx_word_t));
+		memcpy(&source[i], &d, sizeof(lxdmx_word_t));
+		lxdmx_word_t p_ge = lxdmx_ge_mask(p, q);
+		lxdmx_word_t q_ge = lxdmx_ge_mask(q, p);
+		lxdmx_word_t tie = p_ge & q_ge & lxdmx_ge_mask(p, _LXDMX_LOW_BITS);
+		d = (d & p_ge & ~q_ge) | (o & q_ge & ~p_ge) | (lxdmx_max_word(d, o) & tie);
+		if ( changes ) {
+			memcpy(&o, &merged[i], sizeof(lxdmx_word_t));
+			if ( o != d ) {
+				lxdmx_record_changes(changes, &merged[i], (const uint8_t*)&d, i, sizeof(lxdmx_word_t));
+			}
+		}
+		memcpy(&merged[i], &d, sizeof(lxdmx_word_t));
+	}
+
+	for ( ; i < count; i++ ) {
+		uint8_t d = data[i];
+		uint8_t m = 0;
+		if ( priority[i] > other_priority[i] ) {
+			m = d;
+		} else if ( other_priority[i] > priority[i] ) {
+			m = other[i];
+		} else if ( priority[i] ) {
+			m = ( d > other[i] ) ? d : other[i];
+		}
+		source[i] = d;
+		if ( changes && ( merged[i] != m ) ) {
+			lxdmx_record_changes(changes, &merged[i], &m, i, 1);
+		}
+		merged[i] = m;
+	}
+}
+
+void LXDMXMerge::mergeHTP ( uint8_t* source, const uint8_t* data, uint16_t count,
+                            const uint8_t* other, uint8_t* merged, uint16_t total,
+                            LXDMXChanges* changes ) {
+	if ( count > total ) {
+		count = total;
+	}
+	lxdmx_merge(source, data, other, merged, count, changes);
+
+	// remainder: this source has no data so the merge is simply the other source
+	if ( count < total ) {
+		memset(&source[count], 0, total - count);
+		lxdmx_copy(&merged[count], &other[count], total - count, count, changes);
+	}
+}
+
+void LXDMXMerge::mergePriorityHTP ( uint8_t* source, const uint8_t* data, uint16_t count,
+                                    const uint8_t* priority, const uint8_t* other, const uint8_t* other_priority,
+                                    uint8_t* merged, uint16_t total, LXDMXChanges* changes ) {
+	if ( count > total ) {
+		count = total;
+	}
+	lxdmx_merge_priority(source, data, priority, other, other_priority, merged, count, changes);
+
+	// remainder: not sourced here so the merge is the other source where it has priority
+	for (uint16_t i=count; i<total; i++) {
+		uint8_t m = other_priority[i] ? other[i] : 0;
+		source[i] = 0;
+		if ( changes && ( merged[i] != m ) ) {
+			lxdmx_record_changes(changes, &merged[i], &m, i, 1);
+		}
+		merged[i] = m;
+	}
+}
+
+void LXDMXMerge::mergeSlots ( const uint8_t* a, const uint8_t* b, uint8_t* merged, uint16_t count,
+                              LXDMXChanges* changes ) {
+	lxdmx_merge(NULL, a, b, merged, count, changes);
+}
+
+void LXDMXMerge::copySlots ( uint8_t* dest, const uint8_t* data, uint16_t count, uint16_t total,
+                             LXDMXChanges* changes ) {
+	if ( count > total ) {
+		count = total;
+	}
+	lxdmx_copy(dest, data, count, 0, changes);
+	if ( count < total ) {
+		lxdmx_copy(&dest[count], NULL, total - count, count, changes);
+	}
+}
+
+void LXDMXMerge::clearChanges ( LXDMXChanges* changes ) {
+	if ( changes->use_bitmap && ( changes->first != DMX_NO_CHANGE ) ) {
+		// only bytes within the last range can be set
+		memset(&changes->bitmap[changes->first >> 3], 0, (changes->last >> 3) - (changes->first >> 3) + 1);
+	}
+	changes->first = DMX_NO_CHANGE;
+	changes->last = 0;
+}
+
+void LXDMXMerge::addChanges ( LXDMXChanges* changes, uint16_t first, uint16_t last ) {
+	if ( first > last ) {
+		return;
+	}
+	if ( first < changes->first ) {
+		changes->first = first;
+	}
+	if ( last > changes->last ) {
+		changes->last = last;
+	}
+	if ( changes->use_bitmap ) {
+		for (uint16_t k=first; k<=last; k++) {
+			changes->bitmap[k >> 3] |= (1 << (k & 7));
+		}
+	}
+}
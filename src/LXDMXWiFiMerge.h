@@ -0,0 +1,114 @@
+/* LXDMXWiFiMerge.h
+   Copyright 2026 by Claude Heintz Design
+   see LXDMXWiFi.h for LICENSE
+*/
+
+#ifndef LXDMXWIFIMERGE_H
+#define LXDMXWIFIMERGE_H
+
+#include <inttypes.h>
+
+#define DMX_CHANGE_BITMAP_SIZE 64
+#define DMX_NO_CHANGE 0xffff
+
+/*!
+* @brief record of the slots changed by a merge
+* @discussion first and last are buffer indexes.  No change is first == DMX_NO_CHANGE.
+*             The bitmap (one bit per slot, lsb first) is only maintained when use_bitmap is set.
+*/
+typedef struct {
+	uint16_t first;
+	uint16_t last;
+	uint8_t  use_bitmap;
+	uint8_t  bitmap[DMX_CHANGE_BITMAP_SIZE];
+} LXDMXChanges;
+
+/*!
+*  @class LXDMXMerge
+*  @abstract
+*     LXDMXMerge holds the slot merge kernels shared by LXWiFiArtNet and LXWiFiSACN.
+*
+*     Slots are processed a machine word at a time (SWAR) using a branch free byte-wise maximum.
+*     When compiled for a host with SSE2 or ARM NEON, 16 slots are processed per step.
+*     Changed slots are found in the same pass by comparing the new output with the old.
+*/
+class LXDMXMerge {
+
+  public:
+/*!
+* @brief copy new data for one source and merge it HTP with another source in a single pass
+* @discussion source[0..count) = data, source[count..total) = 0
+*             merged[0..count) = max(data, other), merged[count..total) = other
+* @param source buffer holding the levels of the source that sent data
+* @param data slots received from the network
+* @param count number of slots in data
+* @param other buffer holding the levels of the other source
+* @param merged buffer receiving the HTP merge of source and other
+* @param total number of slots to write to source and merged ( >= count )
+* @param changes record of changed slots in merged, may be NULL
+*/
+	static void mergeHTP ( uint8_t* source, const uint8_t* data, uint16_t count,
+	                       const uint8_t* other, uint8_t* merged, uint16_t total,
+	                       LXDMXChanges* changes );
+
+/*!
+* @brief copy new data for one source and merge it with another source by per slot priority
+* @discussion source[0..count) = data, source[count..total) = 0
+*             each slot of merged takes the level of the source with the higher priority for that slot,
+*             HTP when the priorities are equal.  A slot with priority 0 is not sourced.  A slot
+*             sourced by neither is 0.  Slots [count..total) are not sourced by this source.
+*             Priority and levels are compared and changes recorded in a single pass.
+* @param source buffer holding the levels of the source that sent data
+* @param data slots received from the network
+* @param count number of slots in data
+* @param priority priority of each slot of source (at least total bytes)
+* @param other buffer holding the levels of the other source
+* @param other_priority priority of each slot of other, 0 for slots it does not send
+* @param merged buffer receiving the merge of source and other
+* @param total number of slots to write to source and merged ( >= count )
+* @param changes record of changed slots in merged, may be NULL
+*/
+	static void mergePriorityHTP ( uint8_t* source, const uint8_t* data, uint16_t count,
+	                               const uint8_t* priority, const uint8_t* other, const uint8_t* other_priority,
+	                               uint8_t* merged, uint16_t total, LXDMXChanges* changes );
+
+/*!
+* @brief HTP merge of two buffers
+* @discussion merged[0..count) = max(a, b)
+*             merged may be the same buffer as a or b to accumulate the merge of several sources.
+* @param a levels of first source
+* @param b levels of second source
+* @param merged buffer receiving the HTP merge
+* @param count number of slots
+* @param changes record of changed slots in merged, may be NULL
+*/
+	static void mergeSlots ( const uint8_t* a, const uint8_t* b, uint8_t* merged, uint16_t count,
+	                         LXDMXChanges* changes );
+
+/*!
+* @brief copy slots from a single source, zero filling the remainder
+* @discussion dest[0..count) = data, dest[count..total) = 0
+*             Used in place of mergeHTP when there is only one source.
+* @param dest buffer receiving the levels
+* @param data slots received from the network
+* @param count number of slots in data
+* @param total number of slots to write to dest ( >= count )
+* @param changes record of changed slots in dest, may be NULL
+*/
+	static void copySlots ( uint8_t* dest, const uint8_t* data, uint16_t count, uint16_t total,
+	                        LXDMXChanges* changes );
+
+/*!
+* @brief reset a change record to no changes
+*/
+	static void clearChanges ( LXDMXChanges* changes );
+
+/*!
+* @brief mark a range of indexes as changed
+* @param first index of first changed slot
+* @param last index of last changed slot
+*/
+	static void addChanges ( LXDMXChanges* changes, uint16_t first, uint16_t last );
+};
+
+#endif // ifndef LXDMXWIFIMERGE_H
@@ -17,13 +17,35 @@
     v1.2 - adds setLocalAddress
     v1.3 - adds ArtIpProg / ArtIpProgReply
     v1.4 - adds ArtPoll response in input mode
+    v1.5 - adds LXWiFiArtNetNode, word-at-a-time HTP merge
+    v1.6 - single source is copied directly to output without merge
+    v1.7 - adds changed slot reporting
+    v1.8 - discards late ArtDMX using sequence
+    v1.9 - merges up to ARTNET_MAX_SOURCES with source timeout
+    v2.0 - adds ArtSync
+    v2.1 - adds ArtNzs
+    v2.2 - ArtPollReply for multiple ports and BindIndex
+    v2.3 - separate transmit buffer for ArtDMX
+    v2.4 - adds sendDMXOnChange
+    v2.5 - unicasts ArtDMX to subscribers found in ArtPollReply
+    v2.6 - ArtPollReply belongs to each instance and is rebuilt only when changed
+    v2.7 - ArtPollReply is sent after a random delay, coalescing polls
+    v2.8 - ArtTodData in multiple blocks
+    v2.9 - adds ArtRdmSub
+    v3.0 - subscribers are found with LXWiFiArtNetDiscovery
+    v3.1 - adds ArtTimeCode
+    v3.2 - adds ArtInput
 */
 /**************************************************************************/
 
 #include "LXWiFiArtNet.h"
+#include "LXDMXWiFiMerge.h"
+#include "LXWiFiArtNetDiscovery.h"
 
-//static buffer for sending poll replies
-uint8_t LXWiFiArtNet::_reply_buffer[ARTNET_REPLY_SIZE];
+// fixed part of ArtTimeCode: ID, opcode lo-hi, protocol version hi-lo, filler
+static const uint8_t artnet_timecode_header[13] = {
+	'A', 'r', 't', '-', 'N', 'e', 't', 0, 0x00, 0x97, 0, 14, 0
+};
 
 LXWiFiArtNet::LXWiFiArtNet ( IPAddress address )
 {	
@@ -50,6 +72,30 @@ LXWiFiArtNet::~LXWiFiArtNet ( void )
 	if ( _owns_buffer ) {		// if we created this buffer, then free the memory
 		free(_packet_buffer);
 	}
+	while ( _source_count ) {
+		remove_source(_source_count-1);
+	}
+	if ( _merge_buffer ) {
+		free(_merge_buffer);
+	}
+	if ( _sync_buffer ) {
+		free(_sync_buffer);
+	}
+	if ( _nzs_buffer ) {
+		free(_nzs_buffer);
+	}
+	if ( _tx_buffer ) {
+		free(_tx_buffer);
+	}
+	if ( _tx_last ) {
+		free(_tx_last);
+	}
+	if ( _owns_discovery ) {
+		delete _discovery;
+	}
+	if ( _reply_buffer ) {
+		free(_reply_buffer);
+	}
 }
 
 void  LXWiFiArtNet::initialize  ( uint8_t* b ) {
@@ -67,26 +113,51 @@ void  LXWiFiArtNet::initialize  ( uint8_t* b ) {
     for (int n=0; n<ARTNET_BUFFER_MAX; n++) {
     	_packet_buffer[n] = 0;
     	if ( n < DMX_UNIVERSE_SIZE ) {
-    	   _dmx_buffer_a[n] = 0;
-	   	_dmx_buffer_b[n] = 0;
 	   	_dmx_buffer_c[n] = 0;
     	}
     }
     
     _dmx_slots = 0;
-    _dmx_slots_a = 0;
-    _dmx_slots_b = 0;
+    _source_count = 0;
+    _max_sources = ARTNET_DEFAULT_SOURCES;
+    _merge_buffer = NULL;
+    _next_port = NULL;
+    _tx_buffer = NULL;
+    _tx_changed = 1;
+    _tx_last = NULL;
+    _tx_slots = 0;
+    _last_send = 0;
+    _min_send_interval = DMX_MIN_SEND_INTERVAL;
+    _discovery = NULL;
+    _owns_discovery = 0;
+    _subscriber_unicast = 0;
+    _last_poll = millis() - ARTNET_POLL_INTERVAL;	// poll with first sendDMX
+    _sync_buffer = NULL;
+    _sync_slots = 0;
+    _sync_pending = 0;
+    _sync_enabled = 1;
+    _last_sync = 0;
+    _changes.use_bitmap = 0;
+    memset(_changes.bitmap, 0, DMX_CHANGE_BITMAP_SIZE);
+    LXDMXMerge::clearChanges(&_changes);
     _portaddress_lo = 0;
     _portaddress_hi = 0;
     
     _status1 = ARTNET_STATUS1_PORT_PROG;
     _status2 = ARTNET_STATUS2_ARTNET3_CAPABLE;
     
-    _dmx_sender_a = INADDR_NONE;
-    _dmx_sender_b = INADDR_NONE;
+    _sequence_gaps = 0;
+    _sequence_reorders = 0;
     _sequence = 1;
     _poll_reply_counter = 0;
     _poll_reply_enabled = 1;
+    _input_disabled = 0;
+    _poll_reply_pending = 0;
+    _poll_reply_mode = ARTPOLL_OUTPUT_MODE;
+    _poll_reply_time = 0;
+    _poll_reply_wait = 0;
+    _poll_reply_sent = millis() - ARTNET_POLL_COALESCE_TIME;
+    _poll_reply_delay = ARTNET_POLL_REPLY_DELAY;
     
     strcpy(_short_name, "ESP-DMX");
     strcpy(_long_name, "com.claudeheintzdesign.esp-dmx");
@@ -94,21 +165,84 @@ void  LXWiFiArtNet::initialize  ( uint8_t* b ) {
     _artip_receive_callback = 0;
     _art_tod_req_callback = 0;
     _art_rdm_callback = 0;
+    _art_rdm_sub_callback = 0;
+    _art_cmd_callback = 0;
+    _art_poll_reply_callback = 0;
+    _art_indicator_callback = 0;
+    _art_nzs_callback = 0;
+    _art_timecode_callback = 0;
+    _nzs_buffer = NULL;
+    _nzs_slots = 0;
+    _nzs_start_code = 0;
     
-    initializePollReply();
+    _reply_buffer = NULL;
+    _reply_dirty = 1;
+    _reply_report = ARTNET_REPORT_NONE;
 }
 
 void LXWiFiArtNet::clearDMXOutput ( void ) {
-	_dmx_sender_a = INADDR_NONE;
-	_dmx_sender_b = INADDR_NONE;
-	for(int j=0; j<DMX_UNIVERSE_SIZE; j++) {
-	   _dmx_buffer_a[j] = 0;
-	   _dmx_buffer_b[j] = 0;
-	   _dmx_buffer_c[j] = 0;
+	while ( _source_count ) {
+		remove_source(_source_count-1);
+	}
+	if ( _sync_buffer ) {
+		free(_sync_buffer);
+		_sync_buffer = NULL;
 	}
+	LXDMXMerge::clearChanges(&_changes);
+	LXDMXMerge::copySlots(_dmx_buffer_c, NULL, 0, DMX_UNIVERSE_SIZE, &_changes);
 	_dmx_slots = 512;
 }
 
+uint8_t LXWiFiArtNet::maxSources ( void ) {
+	return _max_sources;
+}
+
+void LXWiFiArtNet::setMaxSources ( uint8_t n ) {
+	if ( n < 1 ) {
+		n = 1;
+	} else if ( n > ARTNET_MAX_SOURCES ) {
+		n = ARTNET_MAX_SOURCES;
+	}
+	_max_sources = n;
+	if ( _source_count > n ) {		// drop the newest sources
+		while ( _source_count > n ) {
+			remove_source(_source_count-1);
+		}
+		update_merge_output();
+	}
+}
+
+uint8_t LXWiFiArtNet::numberOfSources ( void ) {
+	return _source_count;
+}
+
+IPAddress LXWiFiArtNet::sourceAddress ( uint8_t index ) {
+	if ( index < _source_count ) {
+		return _sources[index].address;
+	}
+	return INADDR_NONE;
+}
+
+void LXWiFiArtNet::enableSubscriberUnicast ( uint8_t en ) {
+	_subscriber_unicast = en;
+}
+
+LXWiFiArtNetDiscovery* LXWiFiArtNet::discovery ( void ) {
+	if ( _discovery == NULL ) {
+		_discovery = new LXWiFiArtNetDiscovery(_my_address, _broadcast_address);
+		_owns_discovery = 1;
+	}
+	return _discovery;
+}
+
+void LXWiFiArtNet::setDiscovery ( LXWiFiArtNetDiscovery* d ) {
+	if ( _owns_discovery ) {
+		delete _discovery;
+	}
+	_discovery = d;
+	_owns_discovery = 0;
+}
+
 uint16_t  LXWiFiArtNet::universe ( void ) {
 	return _portaddress_lo + ( _portaddress_hi << 8 );
 }
@@ -159,11 +293,80 @@ uint8_t LXWiFiArtNet::getSlot ( int slot ) {
 }
 
 void LXWiFiArtNet::setSlot ( int slot, uint8_t level ) {
-	_packet_buffer[ARTNET_ADDRESS_OFFSET+slot] = level;
+	uint8_t* tx = tx_buffer();
+	if ( tx == NULL ) {
+		return;
+	}
+	if ( tx[ARTNET_ADDRESS_OFFSET+slot] != level ) {
+		tx[ARTNET_ADDRESS_OFFSET+slot] = level;
+		_tx_changed = 1;
+	}
+}
+
+uint16_t LXWiFiArtNet::changedSlotsFirst ( void ) {
+	if ( _changes.first == DMX_NO_CHANGE ) {
+		return 0;
+	}
+	return _changes.first + 1;
+}
+
+uint16_t LXWiFiArtNet::changedSlotsLast ( void ) {
+	if ( _changes.first == DMX_NO_CHANGE ) {
+		return 0;
+	}
+	return _changes.last + 1;
+}
+
+uint8_t LXWiFiArtNet::slotChanged ( int slot ) {
+	uint16_t index = slot - 1;
+	if (( _changes.first == DMX_NO_CHANGE ) || ( index < _changes.first ) || ( index > _changes.last )) {
+		return 0;
+	}
+	if ( _changes.use_bitmap ) {
+		return ( _changes.bitmap[index >> 3] >> (index & 7) ) & 1;
+	}
+	return 1;
+}
+
+void LXWiFiArtNet::setChangedSlotBitmap ( uint8_t en ) {
+	memset(_changes.bitmap, 0, DMX_CHANGE_BITMAP_SIZE);
+	_changes.use_bitmap = en;
+	if ( en && ( _changes.first != DMX_NO_CHANGE ) ) {	// bits were not kept for current range
+		LXDMXMerge::addChanges(&_changes, _changes.first, _changes.last);
+	}
+}
+
+uint8_t* LXWiFiArtNet::changedSlotBitmap ( void ) {
+	return &_changes.bitmap[0];
+}
+
+uint32_t LXWiFiArtNet::sequenceGapCount ( void ) {
+	return _sequence_gaps;
+}
+
+uint32_t LXWiFiArtNet::sequenceReorderCount ( void ) {
+	return _sequence_reorders;
+}
+
+void LXWiFiArtNet::resetSequenceCounts ( void ) {
+	_sequence_gaps = 0;
+	_sequence_reorders = 0;
 }
 
 uint8_t* LXWiFiArtNet::dmxData( void ) {
-	return &_packet_buffer[ARTNET_ADDRESS_OFFSET+1];
+	uint8_t* tx = tx_buffer();
+	if ( tx == NULL ) {
+		return NULL;
+	}
+	if ( _tx_last == NULL ) {		// caller may write directly, keep what was sent to compare
+		_tx_last = (uint8_t*) malloc(DMX_UNIVERSE_SIZE);
+		if ( _tx_last == NULL ) {
+			_tx_changed = 1;		// without the copy, treat as changed
+		} else {
+			memcpy(_tx_last, &tx[ARTNET_ADDRESS_OFFSET+1], DMX_UNIVERSE_SIZE);
+		}
+	}
+	return &tx[ARTNET_ADDRESS_OFFSET+1];
 }
 
 uint8_t* LXWiFiArtNet::packetBuffer( void ) {
@@ -175,18 +378,70 @@ uint16_t LXWiFiArtNet::packetSize( void ) {
 }
 
 uint8_t* LXWiFiArtNet::replyData( void ) {
+	if ( reply_buffer() == NULL ) {
+		return NULL;
+	}
+	if ( _reply_dirty ) {
+		initializePollReply();
+	}
 	return &_reply_buffer[0];
 }
 
 void LXWiFiArtNet::enablePollReply(uint8_t en) {
 	_poll_reply_enabled = en;
+	if ( ! en ) {
+		_poll_reply_pending = 0;
+	}
+}
+
+void LXWiFiArtNet::setPollReplyDelay(uint16_t ms) {
+	_poll_reply_delay = ms;
+}
+
+uint8_t LXWiFiArtNet::sendPendingPollReply(UDP* wUDP) {
+	if ( _poll_reply_pending && ( millis() - _poll_reply_time >= _poll_reply_wait )) {
+		_poll_reply_pending = 0;
+		send_poll_replies(wUDP, _poll_reply_to, _poll_reply_mode);
+		_poll_reply_sent = millis();
+		return 1;
+	}
+	return 0;
+}
+
+void LXWiFiArtNet::enableArtSync(uint8_t en) {
+	_sync_enabled = en;
+	if (( en == 0 ) && _sync_buffer ) {
+		LXDMXMerge::clearChanges(&_changes);
+		end_sync();
+	}
+}
+
+void LXWiFiArtNet::addPort ( LXWiFiArtNet* port ) {
+	LXWiFiArtNet* last = this;
+	while ( last->_next_port ) {
+		last = last->_next_port;
+	}
+	if ( port != this ) {
+		last->_next_port = port;
+		port->_next_port = NULL;
+	}
+}
+
+LXWiFiArtNet* LXWiFiArtNet::nextPort ( void ) {
+	return _next_port;
+}
+
+uint8_t LXWiFiArtNet::syncMode ( void ) {
+	return ( _sync_buffer != NULL );
 }
 
 char* LXWiFiArtNet::shortName( void ) {
+	_reply_dirty = 1;		// caller may write directly
 	return &_short_name[0];
 }
 
 char* LXWiFiArtNet::longName( void ) {
+	_reply_dirty = 1;
 	return &_long_name[0];
 }
 
@@ -209,7 +464,7 @@ uint8_t LXWiFiArtNet::readDMXPacketContents ( UDP* wUDP, uint16_t packetSize ) {
    if ( opcode == ARTNET_ART_DMX ) {
    	return RESULT_DMX_RECEIVED;
    }
-   if ( opcode == ARTNET_ART_POLL ) {
+   if (( opcode == ARTNET_ART_POLL ) || ( opcode == ARTNET_ART_NZS )) {
    	return RESULT_PACKET_COMPLETE;
    }
    return RESULT_NONE;
@@ -225,6 +480,7 @@ uint8_t LXWiFiArtNet::readDMXPacketContents ( UDP* wUDP, uint16_t packetSize ) {
 */
 
 uint16_t LXWiFiArtNet::readArtNetPacket ( UDP* wUDP ) {
+	sendPendingPollReply(wUDP);
 	int packetSize = wUDP->parsePacket();							//change to int to accomodate -1
 	uint16_t opcode = ARTNET_NOP;
 	if ( packetSize > 0 ) {
@@ -237,6 +493,7 @@ uint16_t LXWiFiArtNet::readArtNetPacket ( UDP* wUDP ) {
 }
 
 uint16_t LXWiFiArtNet::readArtNetPacketInputMode ( UDP* wUDP ) {
+	sendPendingPollReply(wUDP);
 	int packetSize = wUDP->parsePacket();
 	uint16_t opcode = ARTNET_NOP;
 	if ( packetSize > 0 ) {
@@ -250,82 +507,32 @@ uint16_t LXWiFiArtNet::readArtNetPacketInputMode ( UDP* wUDP ) {
       
 
 uint16_t LXWiFiArtNet::readArtNetPacketContents ( UDP* wUDP, uint16_t packetSize ) {
-   uint16_t opcode = ARTNET_NOP;
-
-	uint16_t t_slots = 0;
+	sendPendingPollReply(wUDP);
 	/* Buffer now may not contain dmx data for desired universe.
 		After reading the packet into the buffer, check to make sure
 		that it is an Art-Net packet and retrieve the opcode that
 		tells what kind of message it is.                            */
-	opcode = parse_header();
+	return parse_opcode( wUDP, parse_header(), packetSize );
+}
+
+/*
+  opcode is from parse_header, which has already checked the packet
+*/
+uint16_t LXWiFiArtNet::parse_opcode ( UDP* wUDP, uint16_t opcode, uint16_t packetSize ) {
 	switch ( opcode ) {
 		case ARTNET_ART_DMX:
-			// ignore sequence[12] and physical[13]
-			if ( ( _packet_buffer[14] == _portaddress_lo ) && ( _packet_buffer[15] == _portaddress_hi ) && ( _packet_buffer[11] >= 14 )) { //protocol version [10] hi byte [11] lo byte 
-				packetSize -= 18;
-				uint16_t slots = _packet_buffer[17] + (_packet_buffer[16] << 8);
-				if ( packetSize >= slots ) {
-					if (_dmx_sender_a == INADDR_NONE ) {		//if first sender, remember address
-						_dmx_sender_a = wUDP->remoteIP();
-						for(int j=0; j<DMX_UNIVERSE_SIZE; j++) {
-							_dmx_buffer_b[j] = 0;	//insure clear buffer 'b' so cancel merge works properly
-						}
-					}
-					if ( _dmx_sender_a == wUDP->remoteIP() ) {
-						_dmx_slots_a  = slots;
-						if ( _dmx_slots_a > _dmx_slots_b ) {
-							t_slots = _dmx_slots_a;
-						} else {
-							t_slots = _dmx_slots_b;
-						}
-						int di;
-						int dt = ARTNET_ADDRESS_OFFSET + 1;
-						  for (di=0; di<t_slots; di++) {
-						    if ( di < slots ) {								// total slots may be greater than slots in this packet
-							 	_dmx_buffer_a[di] = _packet_buffer[dt+di];
-							}  else {										// don't read beyond end of received slots
-								_dmx_buffer_a[di] = 0;						// set remainder to zero	
-							}
-							if ( _dmx_buffer_a[di] > _dmx_buffer_b[di] ) {
-								_dmx_buffer_c[di] = _dmx_buffer_a[di];
-							} else {
-								_dmx_buffer_c[di] = _dmx_buffer_b[di];
-							}
-						  }
-					} else { 												// did not match sender a
-						if ( _dmx_sender_b == INADDR_NONE) {		// if 2nd sender, remember address
-							_dmx_sender_b = wUDP->remoteIP();
-						}
-						if ( _dmx_sender_b == wUDP->remoteIP() ) {
-						  _dmx_slots_b  = slots;
-							if ( _dmx_slots_a > _dmx_slots_b ) {
-								t_slots = _dmx_slots_a;
-							} else {
-								t_slots = _dmx_slots_b;
-							}
-						  int di;
-						  int dt = ARTNET_ADDRESS_OFFSET + 1;
-						  for (di=0; di<t_slots; di++) {
-							if ( di < slots ) {								//total slots may be greater than slots in this packet				
-							 	_dmx_buffer_b[di] = _packet_buffer[dt+di];
-							}  else {											//don't read beyond end of received slots	
-								_dmx_buffer_b[di] = 0;							//set remainder to zero	
-							}
-							 if ( _dmx_buffer_a[di] > _dmx_buffer_b[di] ) {
-								_dmx_buffer_c[di] = _dmx_buffer_a[di];
-							 } else {
-								_dmx_buffer_c[di] = _dmx_buffer_b[di];
-							 }
-						  }
-						  
-						}  // matched sender b
-					}     // did not match sender a
-				}		   // matched size
-			}			   // matched universe
-			if ( t_slots == 0 ) {	//only set >0 if all of above matched
-				opcode = ARTNET_NOP;
-			} else {
-				_dmx_slots = t_slots;
+			opcode = parse_art_dmx( wUDP, packetSize );
+			break;
+		case ARTNET_ART_NZS:
+			opcode = parse_art_nzs( packetSize );
+			break;
+		case ARTNET_ART_TIMECODE:
+			opcode = parse_art_timecode( packetSize );
+			break;
+		case ARTNET_ART_SYNC:
+			opcode = ARTNET_NOP;
+			if (( packetSize >= 14 ) && ( _packet_buffer[11] >= 14 )) {
+				opcode = parse_art_sync( wUDP );
 			}
 			break;
 		case ARTNET_ART_ADDRESS:
@@ -336,8 +543,8 @@ uint16_t LXWiFiArtNet::readArtNetPacketContents ( UDP* wUDP, uint16_t packetSize
 			break;
 		case ARTNET_ART_POLL:
 			if (( packetSize >= 14 ) && ( _packet_buffer[11] >= 14 )) {
-			    if ( _poll_reply_enabled ) {
-					send_art_poll_reply( wUDP, ARTPOLL_OUTPUT_MODE );
+			    if ( _poll_reply_enabled && ( wUDP->remoteIP() != _my_address )) {	// not our own poll
+					schedule_poll_reply( wUDP, ARTPOLL_OUTPUT_MODE );
 				}
 			}
 			break;
@@ -349,23 +556,29 @@ uint16_t LXWiFiArtNet::readArtNetPacketContents ( UDP* wUDP, uint16_t packetSize
 		case ARTNET_ART_TOD_REQUEST:
 		   opcode = ARTNET_NOP;
 		   if (( packetSize >= 25 ) && ( _packet_buffer[11] >= 14 )) {
-				opcode = parse_art_tod_request( wUDP );
+				opcode = parse_art_tod_request( packetSize );
 			}
 			break;
 		case ARTNET_ART_TOD_CONTROL:
 		   opcode = ARTNET_NOP;
 		   if (( packetSize >= 24 ) && ( _packet_buffer[11] >= 14 )) {
-				opcode = parse_art_tod_request( wUDP );
+				opcode = parse_art_tod_control();
 			}
 			break;
 		case ARTNET_ART_RDM:
 		   opcode = ARTNET_NOP;
 		   if (( packetSize >= 24 ) && ( _packet_buffer[11] >= 14 )) {
-				opcode = parse_art_rdm( wUDP );
+				opcode = parse_art_rdm();
+			}
+			break;
+		case ARTNET_ART_RDM_SUB:
+		   opcode = ARTNET_NOP;
+		   if (( packetSize >= ARTNET_RDM_SUB_HEADER_SIZE ) && ( _packet_buffer[11] >= 14 )) {
+				opcode = parse_art_rdm_sub( packetSize );
 			}
 			break;
 		case ARTNET_ART_CMD:
-			parse_art_cmd( wUDP );
+			parse_art_cmd();
 			break;
 		default:
 			if ( opcode != ARTNET_ART_POLL_REPLY ) {
@@ -378,6 +591,7 @@ uint16_t LXWiFiArtNet::readArtNetPacketContents ( UDP* wUDP, uint16_t packetSize
 
 uint16_t LXWiFiArtNet::readArtNetPacketContentsInputMode ( UDP* wUDP, uint16_t packetSize ) {
    uint16_t opcode = ARTNET_NOP;
+   sendPendingPollReply(wUDP);
 
 	/* Buffer now may not contain dmx data for desired universe.
 		After reading the packet into the buffer, check to make sure
@@ -387,8 +601,8 @@ uint16_t LXWiFiArtNet::readArtNetPacketContentsInputMode ( UDP* wUDP, uint16_t p
 	switch ( opcode ) {
 		case ARTNET_ART_POLL:
 			if (( packetSize >= 14 ) && ( _packet_buffer[11] >= 14 )) {
-			    if ( _poll_reply_enabled ) {
-					send_art_poll_reply( wUDP, ARTPOLL_INPUT_MODE );
+			    if ( _poll_reply_enabled && ( wUDP->remoteIP() != _my_address )) {	// not our own poll
+					schedule_poll_reply( wUDP, ARTPOLL_INPUT_MODE );
 				}
 			}
 			break;
@@ -401,11 +615,25 @@ uint16_t LXWiFiArtNet::readArtNetPacketContentsInputMode ( UDP* wUDP, uint16_t p
 			break;
 			
 		case ARTNET_ART_CMD:
-			parse_art_cmd( wUDP );
+			parse_art_cmd();
 			break;
 			
 		case ARTNET_ART_POLL_REPLY:
-			parse_art_poll_reply( wUDP );
+			parse_art_poll_reply( packetSize );
+			break;
+			
+		case ARTNET_ART_INPUT:
+			opcode = ARTNET_NOP;
+			if ( _packet_buffer[11] >= 14 ) {
+				opcode = parse_art_input( packetSize );
+				if ( opcode == ARTNET_ART_INPUT ) {
+					send_art_poll_reply( wUDP, ARTPOLL_INPUT_MODE );
+				}
+			}
+			break;
+			
+		case ARTNET_ART_TIMECODE:
+			opcode = parse_art_timecode( packetSize );
 			break;
 			
 		default:
@@ -418,52 +646,132 @@ uint16_t LXWiFiArtNet::readArtNetPacketContentsInputMode ( UDP* wUDP, uint16_t p
 }
 
 
+/*
+  only sequence, Port-Address and length change between frames
+  a broadcast is replaced by unicast to each subscriber to this universe
+*/
 void LXWiFiArtNet::sendDMX ( UDP* wUDP, IPAddress to_ip, IPAddress interfaceAddr ) {
-   strcpy((char*)_packet_buffer, "Art-Net");
-   _packet_buffer[8] = 0;        //op code lo-hi
-   _packet_buffer[9] = 0x50;
-   _packet_buffer[10] = 0;
-   _packet_buffer[11] = 14;
+   if ( _input_disabled ) {
+      return;
+   }
+   uint8_t* tx = tx_buffer();
+   if ( tx == NULL ) {
+      return;
+   }
    if ( _sequence == 0 ) {
      _sequence = 1;
    } else {
      _sequence++;
    }
-   _packet_buffer[12] = _sequence;
-   _packet_buffer[13] = 0;
-   _packet_buffer[14] = _portaddress_lo;
-   _packet_buffer[15] = _portaddress_hi;
-   _packet_buffer[16] = _dmx_slots >> 8;
-   _packet_buffer[17] = _dmx_slots & 0xFF;
+   tx[12] = _sequence;
+   tx[14] = _portaddress_lo;
+   tx[15] = _portaddress_hi;
+   tx[16] = _dmx_slots >> 8;
+   tx[17] = _dmx_slots & 0xFF;
    //assume dmx data has been set
   
-   wUDP->beginPacket(to_ip, ARTNET_PORT);
-   wUDP->write(_packet_buffer, _dmx_slots+18);
-   wUDP->endPacket();
+   uint8_t unicast = 0;
+   if ( _subscriber_unicast && is_broadcast(to_ip) ) {
+      if ( millis() - _last_poll >= ARTNET_POLL_INTERVAL ) {
+         send_art_poll(wUDP);
+         _last_poll = millis();
+      }
+      LXWiFiArtNetDiscovery* d = discovery();
+      d->update();
+      uint16_t port_address = universe();
+      uint8_t c = d->firstConsumer(port_address);
+      while ( c != ARTNET_DISCOVERY_NO_NODE ) {
+         wUDP->beginPacket(d->consumerAddress(c), ARTNET_PORT);
+         wUDP->write(tx, _dmx_slots+18);
+         wUDP->endPacket();
+         unicast = 1;
+         c = d->nextConsumer(c, port_address);
+      }
+   }
+   if ( ! unicast ) {
+      wUDP->beginPacket(to_ip, ARTNET_PORT);
+      wUDP->write(tx, _dmx_slots+18);
+      wUDP->endPacket();
+   }
+   if ( _tx_last ) {
+      memcpy(_tx_last, &tx[ARTNET_ADDRESS_OFFSET+1], _dmx_slots);
+   }
+   _tx_changed = 0;
+   _tx_slots = _dmx_slots;
+   _last_send = millis();
+}
+
+/*
+  a change waits only for the minimum interval, otherwise the frame is refreshed
+*/
+uint8_t LXWiFiArtNet::sendDMXOnChange ( UDP* wUDP, IPAddress to_ip, IPAddress interfaceAddr ) {
+   if ( _input_disabled || ( tx_buffer() == NULL )) {
+      return 0;
+   }
+   unsigned long elapsed = millis() - _last_send;
+   if ( tx_changed() ) {
+      if ( elapsed < _min_send_interval ) {
+         return 0;
+      }
+   } else if ( elapsed < ARTNET_REFRESH_INTERVAL ) {
+      return 0;
+   }
+   sendDMX(wUDP, to_ip, interfaceAddr);
+   return 1;
+}
+
+/*
+  levels written through dmxData() are found by comparing with the copy of the last frame sent
+*/
+uint8_t LXWiFiArtNet::tx_changed( void ) {
+   if ( _tx_changed || ( _tx_slots != _dmx_slots ) ) {
+      return 1;
+   }
+   if ( _tx_last ) {
+      return ( memcmp(_tx_last, &_tx_buffer[ARTNET_ADDRESS_OFFSET+1], _dmx_slots) != 0 );
+   }
+   return 0;
+}
+
+void LXWiFiArtNet::setMinimumSendInterval ( uint16_t ms ) {
+   _min_send_interval = ms;
+}
+
+uint8_t* LXWiFiArtNet::tx_buffer( void ) {
+   if ( _tx_buffer == NULL ) {
+      _tx_buffer = (uint8_t*) malloc(ARTNET_BUFFER_MAX);
+      if ( _tx_buffer == NULL ) {
+         return NULL;
+      }
+      memset(_tx_buffer, 0, ARTNET_BUFFER_MAX);
+      strcpy((char*)_tx_buffer, "Art-Net");
+      _tx_buffer[8] = 0;        //op code lo-hi
+      _tx_buffer[9] = 0x50;
+      _tx_buffer[10] = 0;
+      _tx_buffer[11] = 14;
+      _tx_buffer[13] = 0;       //physical
+   }
+   return _tx_buffer;
 }
 
 void LXWiFiArtNet::send_art_poll( UDP* eUDP ) {
    IPAddress a = _broadcast_address;
+   if ( a == (IPAddress)INADDR_ANY ) {
+      a = IPAddress(255,255,255,255);
+   }
    if ( a != INADDR_NONE ) {
-      // modify _reply_buffer for poll content (replace opcode...)
-      _reply_buffer[8] = 0;        // op code lo-hi
-      _reply_buffer[9] = 0x20;
-      _reply_buffer[10] = 0;	//Protocol version hi
-      _reply_buffer[11] = 14;   //low, current version as of Art-Net 4 is 14 (0x0e)
-      _reply_buffer[12] = 0;	//talk options
-      _reply_buffer[13] = 0;	//priority of diagnostics
+      uint8_t poll[ARTNET_POLL_SIZE];
+      strcpy((char*)poll, "Art-Net");
+      poll[8] = 0;        // op code lo-hi
+      poll[9] = 0x20;
+      poll[10] = 0;	//Protocol version hi
+      poll[11] = 14;   //low, current version as of Art-Net 4 is 14 (0x0e)
+      poll[12] = 0;	//talk options
+      poll[13] = 0;	//priority of diagnostics
    
       eUDP->beginPacket(a, ARTNET_PORT);
-      eUDP->write(_reply_buffer, ARTNET_POLL_SIZE);
+      eUDP->write(poll, ARTNET_POLL_SIZE);
       eUDP->endPacket();
-      
-      // return _reply_buffer to poll reply contents
-      _reply_buffer[8] = 0;        // op code lo-hi
-      _reply_buffer[9] = 0x21;
-      _reply_buffer[10] = ((uint32_t)_my_address) & 0xff;      //ip address
-      _reply_buffer[11] = ((uint32_t)_my_address) >> 8;
-      _reply_buffer[12] = ((uint32_t)_my_address) >> 16;
-      _reply_buffer[13] = ((uint32_t)_my_address) >> 24;
    }
   
 }
@@ -473,51 +781,171 @@ void LXWiFiArtNet::send_art_poll( UDP* eUDP ) {
   ( remoteIP is set when parsePacket() is called )
   includes my_ip as address of this node
 */
+/*
+  header and data are written separately so that the data
+  does not have to be copied into the (possibly shared) packet buffer
+*/
+void LXWiFiArtNet::sendNzs ( UDP* wUDP, IPAddress to_ip, uint8_t start_code, uint8_t* data, uint16_t slots ) {
+   if (( slots == 0 ) || ( slots > DMX_UNIVERSE_SIZE ) || _input_disabled ) {
+      return;
+   }
+   if (( start_code == 0 ) || ( start_code == 0xcc )) {
+      return;     // null start code is sent as ArtDmx, RDM as ArtRdm
+   }
+   uint8_t header[ARTNET_ADDRESS_OFFSET+1];
+   strcpy((char*)header, "Art-Net");
+   header[8] = 0;        //op code lo-hi
+   header[9] = 0x51;
+   header[10] = 0;
+   header[11] = 14;
+   if ( _sequence == 0 ) {
+     _sequence = 1;
+   } else {
+     _sequence++;
+   }
+   header[12] = _sequence;
+   header[13] = start_code;
+   header[14] = _portaddress_lo;
+   header[15] = _portaddress_hi;
+   header[16] = slots >> 8;
+   header[17] = slots & 0xFF;
+  
+   wUDP->beginPacket(to_ip, ARTNET_PORT);
+   wUDP->write(header, ARTNET_ADDRESS_OFFSET+1);
+   wUDP->write(data, slots);
+   wUDP->endPacket();
+}
+
+/*
+  the fixed header is copied from artnet_timecode_header so only the time is written per frame
+*/
+void LXWiFiArtNet::sendTimeCode ( UDP* wUDP, IPAddress to_ip, uint8_t hours, uint8_t minutes, uint8_t seconds,
+                                  uint8_t frames, uint8_t type, uint8_t stream_id ) {
+   uint8_t packet[ARTNET_TIMECODE_SIZE];
+   memcpy(packet, artnet_timecode_header, 13);
+   packet[13] = stream_id;
+   packet[14] = frames;
+   packet[15] = seconds;
+   packet[16] = minutes;
+   packet[17] = hours;
+   packet[18] = type;
+
+   wUDP->beginPacket(to_ip, ARTNET_PORT);
+   wUDP->write(packet, ARTNET_TIMECODE_SIZE);
+   wUDP->endPacket();
+}
+
 void LXWiFiArtNet::send_art_poll_reply( UDP* wUDP, uint8_t mode ) { 
-  _poll_reply_counter++;
-  if ( _poll_reply_counter > 9999 ) {
-  	 _poll_reply_counter = 0;
+  IPAddress a = _broadcast_address;
+  if ( a == (IPAddress)INADDR_ANY ) {	   //seemingly unnecessary cast for esp32
+    a = wUDP->remoteIP();   // reply directly if no broadcast address is supplied
   }
-  for (int k=26; k<172; k++) {
-  	_reply_buffer[k] = 0;			// zero short name, long name and status string
+  send_poll_replies(wUDP, a, mode);
+}
+
+/*
+  polls received while a reply is waiting share that reply
+  if they come from different controllers and the reply is not broadcast,
+  the reply is sent to the limited broadcast address
+  polls reaching the same destination shortly after a reply was sent are already answered
+*/
+void LXWiFiArtNet::schedule_poll_reply( UDP* wUDP, uint8_t mode ) {
+  IPAddress a = _broadcast_address;
+  if ( a == (IPAddress)INADDR_ANY ) {
+    a = wUDP->remoteIP();
   }
-  sprintf((char*)&_reply_buffer[108], "#0001 [%04d] ", _poll_reply_counter);
-  
-  if ( mode == ARTPOLL_OUTPUT_MODE ) {
-	if ( _dmx_sender_a != INADDR_NONE ) {
-		sprintf((char*)&_reply_buffer[121], "ArtDMX");
-		if ( _dmx_sender_b != INADDR_NONE ) {
-			sprintf((char*)&_reply_buffer[127], ", 2 Sources");
-			_reply_buffer[182] |= 0x08;  //  merging
-		}
-	} else {
-		sprintf((char*)&_reply_buffer[121], "Idle: no ArtDMX");
-	}
-	_reply_buffer[174] = 0x80;  // can output from network
-	_reply_buffer[182] = 0x80;  // sending DMX flag
-	_reply_buffer[190] = _portaddress_lo & 0x0f;	//output port
-	  
-  } else {
-	  sprintf((char*)&_reply_buffer[121], "DMX Input");
-	  
-	  _reply_buffer[174] = 0x40;  // can input to network
-	  _reply_buffer[186] = _portaddress_lo & 0x0f;	//input port
+  if ( _poll_reply_pending ) {
+    if ( a != _poll_reply_to ) {
+      _poll_reply_to = IPAddress(255,255,255,255);
+    }
+    return;
   }
+  if (( millis() - _poll_reply_sent < ARTNET_POLL_COALESCE_TIME ) && ( mode == _poll_reply_mode )) {
+    if (( a == _poll_reply_to ) || ( _poll_reply_to == IPAddress(255,255,255,255) )) {
+      return;
+    }
+  }
+  _poll_reply_mode = mode;
+  _poll_reply_to = a;
+  if ( _poll_reply_delay == 0 ) {
+    send_poll_replies(wUDP, a, mode);
+    _poll_reply_sent = millis();
+    return;
+  }
+  _poll_reply_pending = 1;
+  _poll_reply_time = millis();
+  _poll_reply_wait = random(_poll_reply_delay);
+}
+
+void LXWiFiArtNet::send_poll_replies( UDP* wUDP, IPAddress a, uint8_t mode ) {
+  if ( reply_buffer() == NULL ) {
+    return;		// no reply without a buffer
+  }
+  update_poll_reply(mode);
   
-  _reply_buffer[173] = 1;    // number of ports
-  strcpy((char*)&_reply_buffer[26], _short_name);
-  strcpy((char*)&_reply_buffer[44], _long_name);
-  _reply_buffer[18] = _portaddress_hi;
-  _reply_buffer[19] = _portaddress_lo >> 4;
-  
-  
-  IPAddress a = _broadcast_address;
-  if ( a == (IPAddress)INADDR_ANY ) {	   //seemingly unnecessary cast for esp32
-    a = wUDP->remoteIP();   // reply directly if no broadcast address is supplied
+  // one reply per bind index, each with up to 4 ports sharing the same net and subnet
+  LXWiFiArtNet* port = this;
+  uint8_t bind_index = 1;
+  while ( port ) {
+	for (int k=172; k<194; k++) {
+		_reply_buffer[k] = 0;			// zero port fields
+	}
+	uint8_t net = port->_portaddress_hi;
+	uint8_t subnet = port->_portaddress_lo >> 4;
+	_reply_buffer[18] = net;
+	_reply_buffer[19] = subnet;
+	
+	uint8_t count = ports_in_reply(port);
+	for (uint8_t n=0; n<count; n++) {
+		if ( mode == ARTPOLL_OUTPUT_MODE ) {
+			_reply_buffer[174+n] = 0x80;  // can output from network
+			_reply_buffer[182+n] = 0x80;  // sending DMX flag
+			if ( port->_source_count > 1 ) {
+				_reply_buffer[182+n] |= 0x08;  //  merging
+			}
+			_reply_buffer[190+n] = port->_portaddress_lo & 0x0f;	//output port
+		} else {
+			_reply_buffer[174+n] = 0x40;  // can input to network
+			if ( port->_input_disabled ) {
+				_reply_buffer[178+n] = 0x08;  // input disabled
+			}
+			_reply_buffer[186+n] = port->_portaddress_lo & 0x0f;	//input port
+		}
+		port = port->_next_port;
+	}
+	_reply_buffer[173] = count;    // number of ports
+	_reply_buffer[211] = bind_index++;
+	
+	wUDP->beginPacket(a, ARTNET_PORT);
+	wUDP->write(_reply_buffer, ARTNET_REPLY_SIZE);
+	wUDP->endPacket();
   }
-  wUDP->beginPacket(a, ARTNET_PORT);
-  wUDP->write(_reply_buffer, ARTNET_REPLY_SIZE);
-  wUDP->endPacket();
+}
+
+/*
+  bind index zero (Art-Net 3 and earlier) is the same as one, the first reply
+*/
+LXWiFiArtNet* LXWiFiArtNet::port_for_bind_index( uint8_t bind_index ) {
+	LXWiFiArtNet* port = this;
+	while ( port && ( bind_index > 1 )) {
+		uint8_t count = ports_in_reply(port);
+		for (uint8_t n=0; n<count; n++) {
+			port = port->_next_port;
+		}
+		bind_index--;
+	}
+	return port;
+}
+
+uint8_t LXWiFiArtNet::ports_in_reply( LXWiFiArtNet* port ) {
+	uint8_t net = port->_portaddress_hi;
+	uint8_t subnet = port->_portaddress_lo >> 4;
+	uint8_t n = 0;
+	while ( port && ( n < ARTNET_PORTS_PER_REPLY ) && ( port->_portaddress_hi == net ) && ( (port->_portaddress_lo >> 4) == subnet )) {
+		n++;
+		port = port->_next_port;
+	}
+	return n;
 }
 
 void LXWiFiArtNet::send_art_ipprog_reply ( UDP* wUDP ) {
@@ -529,70 +957,121 @@ void LXWiFiArtNet::send_art_ipprog_reply ( UDP* wUDP ) {
    wUDP->endPacket();
 }
 
-void LXWiFiArtNet::send_art_tod ( UDP* wUDP, uint8_t* todata, uint8_t ucount ) {
+/*
+  header is built once, only BlockCount and UidCount change between packets
+*/
+void LXWiFiArtNet::send_art_tod ( UDP* wUDP, uint8_t* todata, uint16_t ucount ) {
 	if ( _broadcast_address !=  (IPAddress)INADDR_ANY ) {	//seemingly unnecessary cast for esp32
-		uint8_t _buffer[ARTNET_TOD_PKT_SIZE];
-		int i;
-		for ( i=0; i < ARTNET_TOD_PKT_SIZE; i++ ) {
-			_buffer[i] = 0;
-		}
-		strcpy((char*)_buffer, "Art-Net");
-		_buffer[8] =  0;		// op code lo-hi
-		_buffer[9] =  0x81;
-		_buffer[10] = 0;		// Art-Net version
-		_buffer[11] = 14;
-		_buffer[12] = 1;		// RDM version
-		_buffer[13] = 1;		// physical port
+		uint8_t header[ARTNET_TOD_HEADER_SIZE];
+		memset(header, 0, ARTNET_TOD_HEADER_SIZE);
+		strcpy((char*)header, "Art-Net");
+		header[8] =  0;		// op code lo-hi
+		header[9] =  0x81;
+		header[10] = 0;		// Art-Net version
+		header[11] = 14;
+		header[12] = 1;		// RDM version
+		header[13] = 1;		// physical port
 		//[14-19] spare
-		_buffer[20] = 0;		// bind index root device
-		_buffer[21] = _portaddress_hi;	//net same as [15] of art-dmx
+		header[20] = 0;		// bind index root device
+		header[21] = _portaddress_hi;	//net same as [15] of art-dmx
 		if ( ucount == 0 ) {
-			_buffer[22] = 1;	// command response 1= TOD not available
+			header[22] = 1;	// command response 1= TOD not available
 		}
-		_buffer[23] = _portaddress_lo;	//port-address same as [14] of art-dmx
-		_buffer[24] = 0;			//total UIDs MSB --only single pkt in this implementation
-		_buffer[25] = ucount;		//25 total UIDs LSB
-		_buffer[26] = 0;			//26 block count (sequence# for multiple packets)
-		_buffer[27] = ucount;		//27 UID count
-		uint16_t ulen = 6 * ucount;
-		for( i=0; i<ulen; i++) {
-			_buffer[28+i] = todata[i];
-		} 
+		header[23] = _portaddress_lo;	//port-address same as [14] of art-dmx
+		header[24] = ucount >> 8;		//total UIDs MSB
+		header[25] = ucount & 0xff;		//25 total UIDs LSB
 		
-		wUDP->beginPacket(_broadcast_address, ARTNET_PORT);
-  		wUDP->write(_buffer, ulen+28);
-  		wUDP->endPacket();
+		uint16_t sent = 0;
+		uint8_t block = 0;
+		do {
+			uint16_t n = ucount - sent;
+			if ( n > ARTNET_TOD_MAX_UIDS ) {
+				n = ARTNET_TOD_MAX_UIDS;
+			}
+			header[26] = block++;		//26 block count (sequence# for multiple packets)
+			header[27] = n;				//27 UID count
+			
+			wUDP->beginPacket(_broadcast_address, ARTNET_PORT);
+			wUDP->write(header, ARTNET_TOD_HEADER_SIZE);
+			if ( n ) {
+				wUDP->write(&todata[6*sent], 6*n);
+			}
+			wUDP->endPacket();
+			sent += n;
+		} while ( sent < ucount );
 	}	// broadcast != NULL
 }
 
+/*
+  RDM data following the start code is written directly after the header
+*/
 void LXWiFiArtNet::send_art_rdm ( UDP* wUDP, uint8_t* rdmdata, IPAddress toa ) {
-	uint8_t _buffer[ARTNET_RDM_PKT_SIZE];
-	int i;
-	for ( i=0; i < ARTNET_RDM_PKT_SIZE; i++ ) {
-		_buffer[i] = 0;
-	}
-	strcpy((char*)_buffer, "Art-Net");
-	_buffer[8] =  0;		// op code lo-hi
-	_buffer[9] =  0x83;
-	_buffer[10] = 0;		// Art-Net version
-	_buffer[11] = 14;
-	_buffer[12] = 1;		// RDM version
+	uint8_t header[ARTNET_RDM_HEADER_SIZE];
+	memset(header, 0, ARTNET_RDM_HEADER_SIZE);
+	strcpy((char*)header, "Art-Net");
+	header[8] =  0;		// op code lo-hi
+	header[9] =  0x83;
+	header[10] = 0;		// Art-Net version
+	header[11] = 14;
+	header[12] = 1;		// RDM version
 	//[13-20] spare
-	_buffer[20] = 1;		// bind index root device
-	_buffer[21] = _portaddress_hi;	//net same as [15] of art-dmx
-	_buffer[22] = 0;	// command response 0= process the packet
-	_buffer[23] = _portaddress_lo;	//port-address same as [14] of art-dmx
+	header[20] = 1;		// bind index root device
+	header[21] = _portaddress_hi;	//net same as [15] of art-dmx
+	header[22] = 0;	// command response 0= process the packet
+	header[23] = _portaddress_lo;	//port-address same as [14] of art-dmx
 	
 	uint16_t rlen = rdmdata[2] + 1;
-	for( i=0; i<rlen; i++) {
-		_buffer[24+i] = rdmdata[i+1];
-	} 
 	
 	wUDP->beginPacket(toa, ARTNET_PORT);
-	wUDP->write(_buffer, rlen+24);
+	wUDP->write(header, ARTNET_RDM_HEADER_SIZE);
+	wUDP->write(&rdmdata[1], rlen);
 	wUDP->endPacket();
 }
 
+/*
+  only Set and GetResponse carry values, one 16 bit word per sub-device
+  large ranges are split into consecutive blocks of sub-devices
+*/
+void LXWiFiArtNet::send_art_rdm_sub ( UDP* wUDP, IPAddress toa, uint8_t* uid, uint8_t command_class,
+                                      uint16_t pid, uint16_t sub_device, uint16_t sub_count, uint8_t* data ) {
+	uint8_t header[ARTNET_RDM_SUB_HEADER_SIZE];
+	memset(header, 0, ARTNET_RDM_SUB_HEADER_SIZE);
+	strcpy((char*)header, "Art-Net");
+	header[8] =  0;		// op code lo-hi
+	header[9] =  0x84;
+	header[10] = 0;		// Art-Net version
+	header[11] = 14;
+	header[12] = 1;		// RDM version
+	memcpy(&header[14], uid, 6);
+	header[21] = command_class;
+	header[22] = pid >> 8;
+	header[23] = pid & 0xff;
+	
+	uint8_t has_data = ( command_class == ARTNET_RDM_SUB_SET ) || ( command_class == ARTNET_RDM_SUB_GET_RESPONSE );
+	if ( data == NULL ) {
+		has_data = 0;
+	}
+	uint16_t sent = 0;
+	do {
+		uint16_t n = sub_count - sent;
+		if ( has_data && ( n > ARTNET_RDM_SUB_MAX_COUNT )) {
+			n = ARTNET_RDM_SUB_MAX_COUNT;
+		}
+		header[24] = (sub_device + sent) >> 8;
+		header[25] = (sub_device + sent) & 0xff;
+		header[26] = n >> 8;
+		header[27] = n & 0xff;
+		
+		wUDP->beginPacket(toa, ARTNET_PORT);
+		wUDP->write(header, ARTNET_RDM_SUB_HEADER_SIZE);
+		if ( has_data && n ) {
+			wUDP->write(&data[2*sent], 2*n);
+		}
+		wUDP->endPacket();
+		sent += n;
+	} while ( sent < sub_count );
+}
+
 void LXWiFiArtNet::setArtAddressReceivedCallback(ArtNetReceiveCallback callback) {
 	_artaddress_receive_callback = callback;
 }
@@ -613,6 +1092,38 @@ void LXWiFiArtNet::setArtRDMCallback(ArtNetDataRecvCallback callback) {
 		_art_rdm_callback = callback;
 }
 
+void LXWiFiArtNet::setArtRdmSubCallback(ArtRdmSubRecvCallback callback) {
+	_art_rdm_sub_callback = callback;
+}
+
+void LXWiFiArtNet::setArtNzsCallback(ArtNzsRecvCallback callback) {
+	_art_nzs_callback = callback;
+}
+
+uint8_t LXWiFiArtNet::inputEnabled ( void ) {
+	return ! _input_disabled;
+}
+
+void LXWiFiArtNet::setInputEnabled ( uint8_t en ) {
+	_input_disabled = ! en;
+}
+
+void LXWiFiArtNet::setArtTimeCodeCallback(ArtTimeCodeRecvCallback callback) {
+	_art_timecode_callback = callback;
+}
+
+uint8_t LXWiFiArtNet::nzsStartCode ( void ) {
+	return _nzs_start_code;
+}
+
+uint16_t LXWiFiArtNet::nzsSlots ( void ) {
+	return _nzs_slots;
+}
+
+uint8_t* LXWiFiArtNet::nzsData ( void ) {
+	return _nzs_buffer;
+}
+
 void LXWiFiArtNet::setArtCommandCallback(ArtNetDataRecvCallback callback) {
 		_art_cmd_callback = callback;
 }
@@ -628,6 +1139,336 @@ uint16_t LXWiFiArtNet::parse_header( void ) {
   return ARTNET_NOP;
 }
 
+/*
+  reads an ARTNET_ART_DMX packet
+  data is merged HTP into _dmx_buffer_c if the Port-Address matches this universe
+  returns ARTNET_ART_DMX if the packet contained dmx data for this universe
+  in sync mode, data is merged into _sync_buffer and ARTNET_NOP is returned
+*/
+uint16_t LXWiFiArtNet::parse_art_dmx( UDP* wUDP, uint16_t packetSize ) {
+	uint16_t t_slots = 0;
+	// sequence[12] is checked per sender, ignore physical[13]
+	if ( ( _packet_buffer[14] == _portaddress_lo ) && ( _packet_buffer[15] == _portaddress_hi ) && ( _packet_buffer[11] >= 14 )) { //protocol version [10] hi byte [11] lo byte 
+		packetSize -= 18;
+		uint16_t slots = _packet_buffer[17] + (_packet_buffer[16] << 8);
+		if ( packetSize >= slots ) {
+			IPAddress sender = wUDP->remoteIP();
+			LXDMXMerge::clearChanges(&_changes);	// dropping a source can change the output
+			if ( _sync_buffer && ( (millis() - _last_sync) > ARTNET_SYNC_TIMEOUT )) {
+				end_sync();
+			}
+			expire_sources(sender);
+			uint8_t index = source_for_address(sender);
+			if ( index == ARTNET_NO_SOURCE ) {		// all sources in use
+				return rejected_dmx_result();
+			}
+			if ( _sync_buffer && ( _source_count > 1 )) {	// ArtSync is not used while merging
+				end_sync();
+			}
+			ArtNetDMXSource* source = &_sources[index];
+			if ( ! check_sequence(&source->sequence) ) {
+				return rejected_dmx_result();
+			}
+			source->last_packet = millis();
+			source->slots = slots;
+			for (int k=0; k<_source_count; k++) {
+				if ( _sources[k].slots > t_slots ) {
+					t_slots = _sources[k].slots;
+				}
+			}
+			
+			// total slots may be greater than slots in this packet, remainder is set to zero
+			uint8_t* data = &_packet_buffer[ARTNET_ADDRESS_OFFSET+1];
+			uint16_t total = merge_slots(t_slots);
+			if ( _source_count == 1 ) {
+				// single source: nothing to merge, output holds its levels
+				LXDMXMerge::copySlots(merge_target(), data, slots, total, merge_changes());
+				if ( _sync_buffer ) {
+					_sync_slots = t_slots;
+					_sync_pending = 1;
+					return ARTNET_NOP;
+				}
+			} else if ( _source_count == 2 ) {
+				LXDMXMerge::mergeHTP(source->buffer, data, slots,
+				                     _sources[index ^ 1].buffer, _dmx_buffer_c, total, &_changes);
+			} else {
+				// collect the HTP of the other sources, then merge this packet with it
+				uint8_t first = ( index == 0 ) ? 1 : 0;
+				memcpy(_merge_buffer, _sources[first].buffer, total);
+				for (int k=first+1; k<_source_count; k++) {
+					if ( k != index ) {
+						LXDMXMerge::mergeSlots(_merge_buffer, _sources[k].buffer, _merge_buffer, total, NULL);
+					}
+				}
+				LXDMXMerge::mergeHTP(source->buffer, data, slots,
+				                     _merge_buffer, _dmx_buffer_c, total, &_changes);
+			}
+		}		   // matched size
+	}			   // matched universe
+	if ( t_slots == 0 ) {	//only set >0 if all of above matched
+		return ARTNET_NOP;
+	}
+	_dmx_slots = t_slots;
+	return ARTNET_ART_DMX;
+}
+
+/*
+  reads an ARTNET_ART_NZS packet
+  layout is the same as ArtDMX with the start code in place of physical[13]
+  data is copied to _nzs_buffer, it is not merged and does not affect the dmx levels
+*/
+uint16_t LXWiFiArtNet::parse_art_nzs( uint16_t packetSize ) {
+	if ( ( _packet_buffer[14] == _portaddress_lo ) && ( _packet_buffer[15] == _portaddress_hi ) && ( _packet_buffer[11] >= 14 )) {
+		uint8_t start_code = _packet_buffer[13];
+		uint16_t slots = _packet_buffer[17] + (_packet_buffer[16] << 8);
+		if (( start_code == 0 ) || ( start_code == 0xcc ) || ( slots == 0 ) || ( slots > DMX_UNIVERSE_SIZE )) {
+			return ARTNET_NOP;
+		}
+		if ( packetSize - 18 >= slots ) {
+			if ( _nzs_buffer == NULL ) {
+				_nzs_buffer = (uint8_t*) malloc(DMX_UNIVERSE_SIZE);
+				if ( _nzs_buffer == NULL ) {
+					return ARTNET_NOP;
+				}
+			}
+			memcpy(_nzs_buffer, &_packet_buffer[ARTNET_ADDRESS_OFFSET+1], slots);
+			_nzs_slots = slots;
+			_nzs_start_code = start_code;
+			if ( _art_nzs_callback != NULL ) {
+				_art_nzs_callback(start_code, _nzs_buffer, slots);
+			}
+			return ARTNET_ART_NZS;
+		}
+	}
+	return ARTNET_NOP;
+}
+
+/*
+  reads an ARTNET_ART_SYNC packet
+  ArtSync is only accepted from the single source of ArtDMX
+  the first ArtSync enters sync mode, following ones copy held ArtDMX to output
+*/
+uint16_t LXWiFiArtNet::parse_art_sync( UDP* wUDP ) {
+	LXDMXMerge::clearChanges(&_changes);		// only changes copied by this ArtSync are reported
+	if (( ! _sync_enabled ) || ( _source_count != 1 ) || ( _sources[0].address != wUDP->remoteIP() )) {
+		return ARTNET_NOP;
+	}
+	_last_sync = millis();
+	if ( _sync_buffer == NULL ) {
+		_sync_buffer = (uint8_t*) malloc(DMX_UNIVERSE_SIZE);
+		if ( _sync_buffer ) {
+			memcpy(_sync_buffer, _dmx_buffer_c, DMX_UNIVERSE_SIZE);
+			_sync_slots = _dmx_slots;
+			_sync_pending = 0;
+		}
+		return ARTNET_NOP;
+	}
+	if ( _sync_pending ) {
+		LXDMXMerge::copySlots(_dmx_buffer_c, _sync_buffer, DMX_UNIVERSE_SIZE, DMX_UNIVERSE_SIZE, &_changes);
+		_dmx_slots = _sync_slots;
+		_sync_pending = 0;
+		return ARTNET_ART_DMX;
+	}
+	return ARTNET_NOP;
+}
+
+/*
+  changes to the output are added to _changes
+*/
+void LXWiFiArtNet::end_sync( void ) {
+	if ( _sync_pending ) {
+		LXDMXMerge::copySlots(_dmx_buffer_c, _sync_buffer, DMX_UNIVERSE_SIZE, DMX_UNIVERSE_SIZE, &_changes);
+		_dmx_slots = _sync_slots;
+		_sync_pending = 0;
+	}
+	free(_sync_buffer);
+	_sync_buffer = NULL;
+}
+
+uint8_t* LXWiFiArtNet::merge_target( void ) {
+	if ( _sync_buffer ) {
+		return _sync_buffer;
+	}
+	return _dmx_buffer_c;
+}
+
+LXDMXChanges* LXWiFiArtNet::merge_changes( void ) {
+	if ( _sync_buffer ) {
+		return NULL;
+	}
+	return &_changes;
+}
+
+/*
+  a new source is added if there is room
+  leaving single source mode, the first source's levels are taken from the output
+  source buffers are zeroed beyond their slots so they can be merged over any range
+*/
+uint8_t LXWiFiArtNet::source_for_address( IPAddress address ) {
+	for (int k=0; k<_source_count; k++) {
+		if ( _sources[k].address == address ) {
+			return k;
+		}
+	}
+	if ( _source_count >= _max_sources ) {
+		return ARTNET_NO_SOURCE;
+	}
+	
+	uint8_t* buffer = NULL;
+	if ( _source_count ) {
+		buffer = (uint8_t*) malloc(DMX_UNIVERSE_SIZE);
+		if ( buffer == NULL ) {
+			return ARTNET_NO_SOURCE;
+		}
+		memset(buffer, 0, DMX_UNIVERSE_SIZE);
+		if ( _source_count == 1 ) {
+			_sources[0].buffer = (uint8_t*) malloc(DMX_UNIVERSE_SIZE);
+			if ( _sources[0].buffer == NULL ) {
+				free(buffer);
+				return ARTNET_NO_SOURCE;
+			}
+			LXDMXMerge::copySlots(_sources[0].buffer, merge_target(), _sources[0].slots, DMX_UNIVERSE_SIZE, NULL);
+		} else if ( _merge_buffer == NULL ) {
+			_merge_buffer = (uint8_t*) malloc(DMX_UNIVERSE_SIZE);
+			if ( _merge_buffer == NULL ) {
+				free(buffer);
+				return ARTNET_NO_SOURCE;
+			}
+		}
+	}
+	
+	ArtNetDMXSource* source = &_sources[_source_count];
+	source->address = address;
+	source->buffer = buffer;
+	source->slots = 0;
+	source->sequence = 0;
+	source->last_packet = millis();
+	return _source_count++;
+}
+
+void LXWiFiArtNet::expire_sources( IPAddress current ) {
+	uint8_t removed = 0;
+	for (int k=_source_count-1; k>=0; k--) {
+		if (( _sources[k].address != current ) && ( (millis() - _sources[k].last_packet) > ARTNET_SOURCE_TIMEOUT )) {
+			remove_source(k);
+			removed = 1;
+		}
+	}
+	if ( removed ) {
+		update_merge_output();
+	}
+}
+
+/*
+  later sources move down so that the oldest remaining source is first
+*/
+/*
+  a rejected packet still reports ArtDMX if expiring other sources changed the output
+*/
+uint16_t LXWiFiArtNet::rejected_dmx_result( void ) {
+	if ( _changes.first == DMX_NO_CHANGE ) {
+		return ARTNET_NOP;
+	}
+	uint16_t t_slots = 0;
+	for (int k=0; k<_source_count; k++) {
+		if ( _sources[k].slots > t_slots ) {
+			t_slots = _sources[k].slots;
+		}
+	}
+	_dmx_slots = t_slots;
+	return ARTNET_ART_DMX;
+}
+
+void LXWiFiArtNet::remove_source( uint8_t index ) {
+	if ( _sources[index].buffer ) {
+		free(_sources[index].buffer);
+	}
+	_source_count--;
+	for (int k=index; k<_source_count; k++) {
+		_sources[k] = _sources[k+1];
+	}
+	_sources[_source_count].buffer = NULL;
+}
+
+/*
+  changes to the output are added to _changes
+  a single remaining source goes back to having its levels only in _dmx_buffer_c
+*/
+void LXWiFiArtNet::update_merge_output( void ) {
+	if ( _source_count == 1 ) {
+		if ( _sources[0].buffer ) {
+			LXDMXMerge::copySlots(merge_target(), _sources[0].buffer, DMX_UNIVERSE_SIZE, DMX_UNIVERSE_SIZE, merge_changes());
+			free(_sources[0].buffer);
+			_sources[0].buffer = NULL;
+		}
+	} else if ( _source_count == 2 ) {
+		LXDMXMerge::mergeSlots(_sources[0].buffer, _sources[1].buffer, _dmx_buffer_c, DMX_UNIVERSE_SIZE, &_changes);
+	} else if ( _source_count > 2 ) {
+		memcpy(_merge_buffer, _sources[0].buffer, DMX_UNIVERSE_SIZE);
+		for (int k=1; k<_source_count; k++) {
+			LXDMXMerge::mergeSlots(_merge_buffer, _sources[k].buffer, _merge_buffer, DMX_UNIVERSE_SIZE, NULL);
+		}
+		LXDMXMerge::copySlots(_dmx_buffer_c, _merge_buffer, DMX_UNIVERSE_SIZE, DMX_UNIVERSE_SIZE, &_changes);
+	}
+	if (( _source_count < 3 ) && _merge_buffer ) {
+		free(_merge_buffer);
+		_merge_buffer = NULL;
+	}
+}
+
+uint8_t LXWiFiArtNet::is_broadcast( IPAddress address ) {
+	uint32_t a = (uint32_t) address;
+	if ( a == 0xffffffff ) {
+		return 1;
+	}
+	uint32_t s = (uint32_t) _my_subnetmask;
+	if ( s == 0 ) {
+		return 0;
+	}
+	return ( a | s ) == 0xffffffff;
+}
+
+/*
+  Art-Net sequence runs 0x01-0xff and wraps to 0x01, zero means sequence is not used
+  a packet that is up to ARTNET_SEQUENCE_WINDOW behind the last one (or a repeat of it)
+  is late and is discarded.  Anything further behind is accepted as a restarted sender.
+*/
+uint8_t LXWiFiArtNet::check_sequence( uint8_t* last_sequence ) {
+	uint8_t seq = _packet_buffer[12];
+	if (( seq == 0 ) || ( *last_sequence == 0 )) {
+		*last_sequence = seq;
+		return 1;
+	}
+	int diff = (int)seq - (int)*last_sequence;
+	if ( diff > 127 ) {
+		diff -= 255;
+	} else if ( diff < -127 ) {
+		diff += 255;
+	}
+	if (( diff <= 0 ) && ( diff > -ARTNET_SEQUENCE_WINDOW )) {
+		_sequence_reorders++;
+		return 0;
+	}
+	if ( diff > 1 ) {
+		_sequence_gaps += diff - 1;
+	}
+	*last_sequence = seq;
+	return 1;
+}
+
+/*
+  number of slots written by a merge
+  if the number of slots is shrinking, slots beyond the new count are zeroed
+  so that they are reported as changed
+*/
+uint16_t LXWiFiArtNet::merge_slots( uint16_t t_slots ) {
+	uint16_t n = _sync_buffer ? _sync_slots : _dmx_slots;
+	if (( n > t_slots ) && ( n <= DMX_UNIVERSE_SIZE )) {
+		return n;
+	}
+	return t_slots;
+}
+
 /*
   reads an ARTNET_ART_ADDRESS packet
   can set output universe
@@ -635,42 +1476,53 @@ uint16_t LXWiFiArtNet::parse_header( void ) {
      (after first ArtDmx packet, only packets from the same sender are accepted
      until a cancel merge command is received)
 */
+/*
+  BindIndex[13] selects the ports of one ArtPollReply (see send_poll_replies)
+  net and subnet apply to all of them, SwOut[n] to the nth port
+  cancel merge and clear output with BindIndex zero (Art-Net 3 and earlier) apply to every port
+*/
 uint16_t LXWiFiArtNet::parse_art_address( UDP* wUDP ) {
+	//[13] bind index
 	//[14] to [31] short name <= 18 bytes
 	//[32] to [95] long name  <= 64 bytes
 	//[96][97][98][99]                  input universe   ch 1 to 4
 	//[100][101][102][103]               output universe   ch 1 to 4
+	uint8_t bind_index = _packet_buffer[13];
+	LXWiFiArtNet* bound = port_for_bind_index(bind_index);
+	if ( bound == NULL ) {
+		return ARTNET_NOP;
+	}
 	if ( _packet_buffer[14] != 0 ) {
 		strcpy(_short_name, (char*) &_packet_buffer[14]);
 	}
 	if ( _packet_buffer[32] != 0 ) {
 		strcpy(_long_name, (char*) &_packet_buffer[32]);
 	}
+	_reply_dirty = 1;
 	
-	setNetAddress(_packet_buffer[12]);
-	setUniverseAddress(_packet_buffer[100]);
-	//[104] subnet
-	setSubnetAddress(_packet_buffer[104]);
+	uint8_t count = ports_in_reply(bound);	// before net or subnet change
+	LXWiFiArtNet* port = bound;
+	for (uint8_t n=0; n<count; n++) {
+		port->setNetAddress(_packet_buffer[12]);
+		port->setUniverseAddress(_packet_buffer[100+n]);
+		//[104] subnet
+		port->setSubnetAddress(_packet_buffer[104]);
+		port = port->_next_port;
+	}
 	//[105] reserved
 	uint8_t command = _packet_buffer[106]; // command
+	uint8_t cleared = 0;
 	switch ( command ) {
 	   case 0x00:
 	      if ( _artaddress_receive_callback != NULL ) {	//notify settings may have changed
 				_artaddress_receive_callback();
 			}
 			break;
-	   case 0x01:	//cancel merge: resets ip address used to identify dmx sender
-	   if ( _dmx_sender_a != wUDP->remoteIP() ) {
-	   		_dmx_sender_a = INADDR_NONE;
-	   		for (int k=0; k<DMX_UNIVERSE_SIZE; k++) {
-	   			_dmx_buffer_a[k] = 0;
-	   		}
-	   	}
-	   	if ( _dmx_sender_b != wUDP->remoteIP() ) {
-	   		_dmx_sender_b = INADDR_NONE;
-	   		for (int k=0; k<DMX_UNIVERSE_SIZE; k++) {
-	   			_dmx_buffer_b[k] = 0;
-	   		}
+	   case 0x01:	//cancel merge: drops all sources except the sender of the command
+	   	port = bound;
+	   	for (uint8_t n=0; port && (( n<count ) || ( bind_index == 0 )); n++) {
+	   		port->cancel_merge(wUDP->remoteIP());
+	   		port = port->_next_port;
 	   	}
 	   	break;
         case 0x02:
@@ -688,16 +1540,43 @@ uint16_t LXWiFiArtNet::parse_art_address( UDP* wUDP ) {
  				_art_indicator_callback(false, false, true);
  			}
  			break;
-	   case 0x90:	//clear buffer
-	   	clearDMXOutput();
-	   	return ARTNET_ART_DMX;	// return ARTNET_ART_DMX so function calling readPacket
-	   	   						   // knows there has been a change in levels
+	   case 0x90:	//clear output of port n, 0x90 with bind index zero clears every port
+	   case 0x91:
+	   case 0x92:
+	   case 0x93:
+	   	port = bound;
+	   	if (( bind_index == 0 ) && ( command == 0x90 )) {
+	   		while ( port ) {
+	   			port->clearDMXOutput();
+	   			port = port->_next_port;
+	   		}
+	   		cleared = 1;
+	   	} else if ( (command & 0x03) < count ) {
+	   		for (uint8_t n=0; n<(command & 0x03); n++) {
+	   			port = port->_next_port;
+	   		}
+	   		port->clearDMXOutput();
+	   		cleared = 1;
+	   	}
 	   	break;
 	}
 	
+	if ( cleared ) {
+		return ARTNET_ART_DMX;		// so function calling readPacket knows there has been a change in levels
+	}
 	return ARTNET_ART_ADDRESS;
 }
 
+void LXWiFiArtNet::cancel_merge( IPAddress sender ) {
+	for (int k=_source_count-1; k>=0; k--) {
+		if ( _sources[k].address != sender ) {
+			remove_source(k);
+		}
+	}
+	LXDMXMerge::clearChanges(&_changes);
+	update_merge_output();
+}
+
 void LXWiFiArtNet::parse_art_ipprog( UDP* wUDP ) {
    uint8_t cmd = _packet_buffer[14];
    if ( cmd & 0x80 ) {
@@ -725,20 +1604,34 @@ void LXWiFiArtNet::parse_art_ipprog( UDP* wUDP ) {
 	}
 }
 
-uint16_t LXWiFiArtNet::parse_art_tod_request( UDP* wUDP ) {
+/*
+  Address[24] is an array of up to 32 low bytes of Port-Address, AdCount[23] are used
+*/
+uint16_t LXWiFiArtNet::parse_art_tod_request( uint16_t packetSize ) {
 	if ( _art_tod_req_callback != NULL ) {
 		if ( _packet_buffer[21] == _portaddress_hi ) {
-			if ( _packet_buffer[24] == _portaddress_lo ) {	//array[32] of port-address
-				uint8_t type = 0;
-				_art_tod_req_callback(&type);	//pointer to uint8_t could be array of other params
-				return ARTNET_ART_TOD_REQUEST;
+			uint8_t count = _packet_buffer[23];
+			if ( count > packetSize - 24 ) {
+				count = packetSize - 24;
+			}
+			if ( count > 32 ) {
+				count = 32;
+			} else if ( count == 0 ) {
+				count = 1;
+			}
+			for (uint8_t k=0; k<count; k++) {
+				if ( _packet_buffer[24+k] == _portaddress_lo ) {
+					uint8_t type = 0;
+					_art_tod_req_callback(&type);	//pointer to uint8_t could be array of other params
+					return ARTNET_ART_TOD_REQUEST;
+				}
 			}
 		}
 	}
 	return ARTNET_NOP;
 }
 
-uint16_t LXWiFiArtNet::parse_art_tod_control( UDP* wUDP ) {
+uint16_t LXWiFiArtNet::parse_art_tod_control( void ) {
 	if ( _art_tod_req_callback != NULL ) {
 		if ( _packet_buffer[21] == _portaddress_hi ) {
 			if ( _packet_buffer[23] == _portaddress_lo ) {
@@ -751,7 +1644,75 @@ uint16_t LXWiFiArtNet::parse_art_tod_control( UDP* wUDP ) {
 	return ARTNET_NOP;
 }
 
-uint16_t LXWiFiArtNet::parse_art_rdm( UDP* wUDP ) {
+/*
+  ArtRdmSub is addressed by UID rather than Port-Address
+  packet must contain the values implied by command class and SubCount
+*/
+uint16_t LXWiFiArtNet::parse_art_rdm_sub( uint16_t packetSize ) {
+	if ( _art_rdm_sub_callback == NULL ) {
+		return ARTNET_NOP;
+	}
+	uint8_t command_class = _packet_buffer[21];
+	uint16_t sub_count = (_packet_buffer[26] << 8) | _packet_buffer[27];
+	uint16_t dlen = 0;
+	if (( command_class == ARTNET_RDM_SUB_SET ) || ( command_class == ARTNET_RDM_SUB_GET_RESPONSE )) {
+		dlen = 2 * sub_count;
+	} else if (( command_class != ARTNET_RDM_SUB_GET ) && ( command_class != ARTNET_RDM_SUB_SET_RESPONSE )) {
+		return ARTNET_NOP;
+	}
+	if ( packetSize < ARTNET_RDM_SUB_HEADER_SIZE + dlen ) {
+		return ARTNET_NOP;
+	}
+	_art_rdm_sub_callback(&_packet_buffer[14], command_class,
+	                      (_packet_buffer[22] << 8) | _packet_buffer[23],
+	                      (_packet_buffer[24] << 8) | _packet_buffer[25],
+	                      sub_count, &_packet_buffer[ARTNET_RDM_SUB_HEADER_SIZE]);
+	return ARTNET_ART_RDM_SUB;
+}
+
+/*
+  BindIndex selects the reply (group of up to 4 ports) that Input[] applies to,
+  as numbered by send_poll_replies.  Bit 0 of Input[n] disables port n.
+*/
+uint16_t LXWiFiArtNet::parse_art_input( uint16_t packetSize ) {
+	if ( packetSize < ARTNET_INPUT_SIZE ) {		// through Input[4]
+		return ARTNET_NOP;
+	}
+	LXWiFiArtNet* port = port_for_bind_index(_packet_buffer[13]);
+	if ( port == NULL ) {
+		return ARTNET_NOP;
+	}
+	uint16_t num_ports = (_packet_buffer[14] << 8) | _packet_buffer[15];
+	uint8_t count = ports_in_reply(port);
+	if ( num_ports < count ) {
+		count = num_ports;
+	}
+	for (uint8_t n=0; n<count; n++) {
+		port->_input_disabled = _packet_buffer[16+n] & 0x01;
+		port = port->_next_port;
+	}
+	return ARTNET_ART_INPUT;
+}
+
+/*
+  called directly from the packet switch so that timecode is passed on without waiting for other work
+  values out of range are discarded
+*/
+uint16_t LXWiFiArtNet::parse_art_timecode( uint16_t packetSize ) {
+	if (( _art_timecode_callback == NULL ) || ( packetSize < ARTNET_TIMECODE_SIZE ) || ( _packet_buffer[11] < 14 )) {
+		return ARTNET_NOP;
+	}
+	uint8_t type = _packet_buffer[18];
+	if (( type > ARTNET_TIMECODE_SMPTE ) || ( _packet_buffer[14] > 29 ) || ( _packet_buffer[15] > 59 ) ||
+	    ( _packet_buffer[16] > 59 ) || ( _packet_buffer[17] > 23 )) {
+		return ARTNET_NOP;
+	}
+	_art_timecode_callback(_packet_buffer[17], _packet_buffer[16], _packet_buffer[15], _packet_buffer[14],
+	                       type, _packet_buffer[13]);
+	return ARTNET_ART_TIMECODE;
+}
+
+uint16_t LXWiFiArtNet::parse_art_rdm( void ) {
 	if ( _art_rdm_callback != NULL ) {
 		if ( _packet_buffer[21] == _portaddress_hi ) {
 			if ( _packet_buffer[23] == _portaddress_lo ) {
@@ -763,7 +1724,7 @@ uint16_t LXWiFiArtNet::parse_art_rdm( UDP* wUDP ) {
 	return ARTNET_NOP;
 }
 
-void LXWiFiArtNet::parse_art_cmd( UDP* wUDP ) {
+void LXWiFiArtNet::parse_art_cmd( void ) {
 	if ( _art_cmd_callback != NULL ) {
 		if ( _packet_buffer[12] == 0xFF ) {			// wildcard mfg ID
 			if ( _packet_buffer[13] == 0xFF ) {
@@ -775,7 +1736,10 @@ void LXWiFiArtNet::parse_art_cmd( UDP* wUDP ) {
 	}
 }
 
-uint16_t LXWiFiArtNet::parse_art_poll_reply( UDP* wUDP ) {
+uint16_t LXWiFiArtNet::parse_art_poll_reply( uint16_t packetSize ) {
+	if ( _subscriber_unicast ) {
+		discovery()->readPollReply(_packet_buffer, packetSize);
+	}
     if ( _art_poll_reply_callback != NULL ) {
 		_art_poll_reply_callback(_packet_buffer);
 	}
@@ -784,11 +1748,10 @@ uint16_t LXWiFiArtNet::parse_art_poll_reply( UDP* wUDP ) {
 
 void LXWiFiArtNet::setLocalAddress ( IPAddress address ) {
 	_my_address = address;
-	
-	_reply_buffer[10] = ((uint32_t)_my_address) & 0xff;      //ip address
-  	_reply_buffer[11] = ((uint32_t)_my_address) >> 8;
-  	_reply_buffer[12] = ((uint32_t)_my_address) >> 16;
-  	_reply_buffer[13] = ((uint32_t)_my_address) >>24;
+	_reply_dirty = 1;
+	if ( _owns_discovery ) {
+		_discovery->setAddresses(_my_address, _broadcast_address);
+	}
 }
 
 void  LXWiFiArtNet::setLocalAddressMask ( IPAddress address, IPAddress subnet_mask ) {
@@ -798,6 +1761,9 @@ void  LXWiFiArtNet::setLocalAddressMask ( IPAddress address, IPAddress subnet_ma
 	uint32_t a = (uint32_t) address;
     uint32_t s = (uint32_t) subnet_mask;
     _broadcast_address = IPAddress(a | ~s);
+    if ( _owns_discovery ) {
+       _discovery->setAddresses(_my_address, _broadcast_address);
+    }
 }
 
 void LXWiFiArtNet::setStatus1Flag ( uint8_t flag, uint8_t set ) {
@@ -806,7 +1772,7 @@ void LXWiFiArtNet::setStatus1Flag ( uint8_t flag, uint8_t set ) {
 	} else {
 		_status1 &= ~flag;
 	}
-	_reply_buffer[23] = _status1;
+	_reply_dirty = 1;
 }
 
 void  LXWiFiArtNet::setStatus2Flag ( uint8_t flag, uint8_t set ) {
@@ -815,7 +1781,7 @@ void  LXWiFiArtNet::setStatus2Flag ( uint8_t flag, uint8_t set ) {
 	} else {
 		_status2 &= ~flag;
 	}
-	_reply_buffer[212] = _status2;
+	_reply_dirty = 1;
 }
 
 void  LXWiFiArtNet::initializePollReply  ( void ) {
@@ -847,6 +1813,60 @@ void  LXWiFiArtNet::initializePollReply  ( void ) {
   _reply_buffer[173] = 1;    // number of ports
   
   _reply_buffer[190] = _portaddress_lo & 0x0f;
+  memcpy(&_reply_buffer[207], &_reply_buffer[10], 4);	// bind ip is the address of the root device
   _reply_buffer[211] = 1;	 // bind index of root device is always 1
   _reply_buffer[212] = _status2;
+  _reply_dirty = 0;
+  _reply_report = ARTNET_REPORT_NONE;
+}
+
+uint8_t* LXWiFiArtNet::reply_buffer( void ) {
+   if ( _reply_buffer == NULL ) {
+      _reply_buffer = (uint8_t*) malloc(ARTNET_REPLY_SIZE);
+      if ( _reply_buffer == NULL ) {
+         return NULL;
+      }
+      _reply_dirty = 1;
+   }
+   return _reply_buffer;
+}
+
+/*
+  NodeReport text is rewritten only when the number of sources or mode changes
+  the counter digits [115-118] of "#0001 [0000] " are patched for each reply
+*/
+void LXWiFiArtNet::update_poll_reply( uint8_t mode ) {
+  reply_buffer();
+  if ( _reply_dirty ) {
+    initializePollReply();
+  }
+  
+  uint8_t report = ( mode == ARTPOLL_OUTPUT_MODE ) ? _source_count : ARTNET_REPORT_INPUT;
+  if ( report != _reply_report ) {
+    for (int k=108; k<172; k++) {
+  	  _reply_buffer[k] = 0;
+    }
+    strcpy((char*)&_reply_buffer[108], "#0001 [0000] ");
+    if ( report == ARTNET_REPORT_INPUT ) {
+	  strcpy((char*)&_reply_buffer[121], "DMX Input");
+    } else if ( report ) {
+	  strcpy((char*)&_reply_buffer[121], "ArtDMX");
+	  if ( report > 1 ) {
+		sprintf((char*)&_reply_buffer[127], ", %d Sources", report);
+	  }
+    } else {
+	  strcpy((char*)&_reply_buffer[121], "Idle: no ArtDMX");
+    }
+    _reply_report = report;
+  }
+  
+  _poll_reply_counter++;
+  if ( _poll_reply_counter > 9999 ) {
+  	 _poll_reply_counter = 0;
+  }
+  uint16_t c = _poll_reply_counter;
+  for (int k=118; k>114; k--) {
+    _reply_buffer[k] = '0' + ( c % 10 );
+    c /= 10;
+  }
 }
@@ -10,31 +10,66 @@
 
 #include <Arduino.h>
 #include "LXDMXWiFi.h"
+#include "LXDMXWiFiMerge.h"
 
 #define ARTNET_PORT 0x1936
 #define ARTNET_BUFFER_MAX 530
 #define ARTNET_REPLY_SIZE 240
 #define ARTNET_POLL_SIZE  14
 #define ARTNET_TOD_PKT_SIZE	1228
+#define ARTNET_TOD_HEADER_SIZE 28
+#define ARTNET_TOD_MAX_UIDS 200
 #define ARTNET_RDM_PKT_SIZE 281
+#define ARTNET_RDM_HEADER_SIZE 24
+#define ARTNET_RDM_SUB_HEADER_SIZE 32
+#define ARTNET_RDM_SUB_MAX_COUNT 240
+#define ARTNET_TIMECODE_SIZE 19
+#define ARTNET_INPUT_SIZE 20
 #define ARTNET_IPPROG_SIZE 34
 #define ARTNET_ADDRESS_OFFSET 17
 #define ARTNET_SHORT_NAME_LENGTH 18
 #define ARTNET_LONG_NAME_LENGTH 64
+#define ARTNET_SEQUENCE_WINDOW 20
+#define ARTNET_MAX_SOURCES 8
+#define ARTNET_DEFAULT_SOURCES 2
+#define ARTNET_SOURCE_TIMEOUT 10000
+#define ARTNET_NO_SOURCE 0xff
+#define ARTNET_SYNC_TIMEOUT 4000
+#define ARTNET_PORTS_PER_REPLY 4
+#define ARTNET_REFRESH_INTERVAL 4000
+#define ARTNET_POLL_INTERVAL 3000
+#define ARTNET_POLL_REPLY_DELAY 1000
+#define ARTNET_POLL_COALESCE_TIME 500
 
 
 #define ARTNET_ART_POLL 		0x2000
 #define ARTNET_ART_POLL_REPLY	0x2100
 #define ARTNET_ART_CMD			0x2400
 #define ARTNET_ART_DMX			0x5000
+#define ARTNET_ART_NZS			0x5100
+#define ARTNET_ART_SYNC			0x5200
 #define ARTNET_ART_ADDRESS		0x6000
+#define ARTNET_ART_INPUT		0x7000
 #define ARTNET_ART_IPPROG		0xF800
 #define ARTNET_ART_IPPROG_REPLY 0xF900
 #define ARTNET_ART_TOD_REQUEST	0x8000
 #define ARTNET_ART_TOD_CONTROL	0x8200
 #define ARTNET_ART_RDM			0x8300
+#define ARTNET_ART_RDM_SUB		0x8400
+#define ARTNET_ART_TIMECODE		0x9700
 #define ARTNET_NOP 				0x0000
 
+#define ARTNET_RDM_SUB_GET			0x20
+#define ARTNET_RDM_SUB_GET_RESPONSE	0x21
+#define ARTNET_RDM_SUB_SET			0x30
+#define ARTNET_RDM_SUB_SET_RESPONSE	0x31
+
+// ArtTimeCode Type
+#define ARTNET_TIMECODE_FILM		0
+#define ARTNET_TIMECODE_EBU			1
+#define ARTNET_TIMECODE_DF			2
+#define ARTNET_TIMECODE_SMPTE		3
+
 #define ARTADDRESS_NO_CHANGE 0x7f
 #define ARTADDRESS_PROG_BIT 0x80
 
@@ -48,11 +83,32 @@
 
 #define ARTPOLL_OUTPUT_MODE 0
 #define ARTPOLL_INPUT_MODE  1
+#define ARTNET_REPORT_INPUT 0xff
+#define ARTNET_REPORT_NONE  0xfe
 
 typedef void (*ArtNetReceiveCallback)(void);
 typedef void (*ArtNetDataRecvCallback)(uint8_t* pdata);
 typedef void (*ArtIpProgRecvCallback)(uint8_t cmd, IPAddress ipaddr, IPAddress subnet);
 typedef void (*ArtNetIndicatorCallback)(bool normal, bool mute, bool locate);
+typedef void (*ArtNzsRecvCallback)(uint8_t start_code, uint8_t* pdata, uint16_t slots);
+typedef void (*ArtRdmSubRecvCallback)(uint8_t* uid, uint8_t command_class, uint16_t pid,
+                                      uint16_t sub_device, uint16_t sub_count, uint8_t* pdata);
+typedef void (*ArtTimeCodeRecvCallback)(uint8_t hours, uint8_t minutes, uint8_t seconds, uint8_t frames,
+                                        uint8_t type, uint8_t stream_id);
+
+/*!
+* @brief a sender of ArtDMX packets being merged
+* @discussion buffer is allocated only while there is more than one source.
+*/
+typedef struct {
+	IPAddress     address;
+	uint8_t*      buffer;
+	uint16_t      slots;
+	uint8_t       sequence;
+	unsigned long last_packet;
+} ArtNetDMXSource;
+
+class LXWiFiArtNetDiscovery;
 
 /*!
 *  @class LXWiFiArtNet
@@ -60,9 +116,9 @@ typedef void (*ArtNetIndicatorCallback)(bool normal, bool mute, bool locate);
 *     LXWiFiArtNet partially implements the Art-Net Ethernet Communication Standard.
 *  
 *  	LXWiFiArtNet is primarily a node implementation.  It supports output of a single universe
-*     of DMX data from the network.  It does not support merge and will only accept
-*     packets from the first IP address from which it receives an ArtDMX packet.
-*     This can be reset by sending an ArtAddress cancel merge command.
+*     of DMX data from the network.  ArtDMX packets from up to maxSources() IP addresses
+*     are merged HTP.  A source that has not sent for ARTNET_SOURCE_TIMEOUT is dropped
+*     from the merge.  All other sources can be dropped by an ArtAddress cancel merge command.
 *     
 *     When reading packets, LXWiFiArtNet will automatically respond to ArtPoll packets.
 *     Depending on the constructor used, it will either broadcast the reply or will
@@ -72,6 +128,9 @@ typedef void (*ArtNetIndicatorCallback)(bool normal, bool mute, bool locate);
 */
 class LXWiFiArtNet : public LXDMXWiFi {
 
+/// LXWiFiArtNetNode parses the header once and hands ArtDMX to the matching universe
+  friend class LXWiFiArtNetNode;
+
   public:
 /*!
 * @brief constructor with address used for ArtPollReply
@@ -169,6 +228,7 @@ class LXWiFiArtNet : public LXDMXWiFi {
    uint8_t  getSlot      ( int slot );
  /*!
  * @brief set level data (0-255) for slot/address/channel
+ * @discussion level is set in the transmit buffer used by sendDMX
  * @param slot 1 to 512
  * @param level level 0 to 255
  */  
@@ -178,10 +238,97 @@ class LXWiFiArtNet : public LXDMXWiFi {
  * @brief clear dmx buffers and sender IP addresses
  */    
    void clearDMXOutput ( void );
+
+ /*!
+ * @brief maximum number of sources merged
+ */
+   uint8_t  maxSources ( void );
+ /*!
+ * @brief set maximum number of sources merged
+ * @discussion Each source beyond the first uses DMX_UNIVERSE_SIZE bytes while it is active.
+ *             Three or more sources use an additional DMX_UNIVERSE_SIZE bytes.
+ * @param n 1 to ARTNET_MAX_SOURCES, default is ARTNET_DEFAULT_SOURCES
+ */
+   void     setMaxSources ( uint8_t n );
+ /*!
+ * @brief number of sources currently being merged
+ */
+   uint8_t  numberOfSources ( void );
+ /*!
+ * @brief IP address of a source
+ * @param index 0 to numberOfSources()-1, oldest source first
+ * @return address or INADDR_NONE
+ */
+   IPAddress sourceAddress ( uint8_t index );
+
+ /*!
+ * @brief enable unicast of ArtDMX to subscribers
+ * @discussion Disabled by default.  When enabled, ArtPollReply packets are recorded in discovery().
+ *             sendDMX to a broadcast address is then unicast to each node with an output port
+ *             matching this universe, or broadcast if there are none.
+ *             ArtPoll is broadcast every ARTNET_POLL_INTERVAL while sending to keep the directory current.
+ * @param en 1 to enable
+ */
+   void     enableSubscriberUnicast ( uint8_t en );
+ /*!
+ * @brief directory of nodes found in ArtPollReply
+ * @discussion created when first needed unless set with setDiscovery
+ * @return pointer to LXWiFiArtNetDiscovery
+ */
+   LXWiFiArtNetDiscovery* discovery ( void );
+ /*!
+ * @brief use a directory shared with other instances
+ * @discussion The directory is not deleted with this instance.
+ *             Only one of the instances sharing a directory needs to read ArtPollReply packets.
+ * @param d pointer to LXWiFiArtNetDiscovery or NULL to use a directory belonging to this instance
+ */
+   void     setDiscovery ( LXWiFiArtNetDiscovery* d );
+
+ /*!
+ * @brief first slot changed by the last ArtDMX packet read
+ * @return slot 1 to 512 or 0 if no slots changed
+ */
+   uint16_t changedSlotsFirst ( void );
+ /*!
+ * @brief last slot changed by the last ArtDMX packet read
+ * @return slot 1 to 512 or 0 if no slots changed
+ */
+   uint16_t changedSlotsLast  ( void );
+ /*!
+ * @brief test if a slot was changed by the last ArtDMX packet read
+ * @param slot 1 to 512
+ * @return 1 if slot changed
+ */
+   uint8_t  slotChanged       ( int slot );
+ /*!
+ * @brief enable per-slot change bitmap
+ * @param en 1 to maintain bitmap
+ */
+   void     setChangedSlotBitmap ( uint8_t en );
+ /*!
+ * @brief direct pointer to changed slot bitmap
+ * @return uint8_t[64], one bit per slot
+ */
+   uint8_t* changedSlotBitmap ( void );
+
+ /*!
+ * @brief number of ArtDMX packets missing from the sequence of a sender
+ * @discussion counts the packets skipped over when a sequence number jumps ahead
+ */
+   uint32_t sequenceGapCount ( void );
+ /*!
+ * @brief number of ArtDMX packets discarded because they arrived late or out of order
+ */
+   uint32_t sequenceReorderCount ( void );
+ /*!
+ * @brief reset sequence gap and reorder counts to zero
+ */
+   void     resetSequenceCounts ( void );
 	
  /*!
- * @brief direct pointer to dmx portion of packet buffer uint8_t[]
- * @return uint8_t* to dmx data portion of packet buffer
+ * @brief direct pointer to dmx portion of transmit buffer uint8_t[]
+ * @discussion Data for sendDMX.  Received levels are read with getSlot.
+ * @return uint8_t* to dmx data portion of transmit buffer or NULL if it could not be allocated
  */ 
    uint8_t* dmxData      ( void );
    
@@ -199,7 +346,9 @@ class LXWiFiArtNet : public LXDMXWiFi {
    
 /*!
  * @brief direct pointer to poll reply packet contents
- * @return uint8_t* to poll reply packet contents
+ * @discussion The reply is rebuilt only after a change to address, names or status.
+ *             Port fields, bind index and NodeReport are written as each reply is sent.
+ * @return uint8_t* to poll reply packet contents or NULL if the reply could not be allocated
  */ 
    uint8_t* replyData      ( void );
    
@@ -208,6 +357,55 @@ class LXWiFiArtNet : public LXDMXWiFi {
  * @param en enable flag
  */    
    void enablePollReply(uint8_t en);
+/*!
+ * @brief input port is enabled
+ * @discussion An ArtInput packet from a controller can disable the input port.
+ *             While disabled, sendDMX, sendDMXOnChange and sendNzs do not send
+ *             and GoodInput of ArtPollReply shows the port as disabled.
+ * @return 1 if enabled (default)
+ */
+   uint8_t  inputEnabled ( void );
+/*!
+ * @brief enable or disable input port as if by ArtInput
+ * @param en 0 to disable
+ */
+   void     setInputEnabled ( uint8_t en );
+/*!
+ * @brief maximum random delay before replying to ArtPoll
+ * @discussion The reply is sent after a random delay of up to ms (default ARTNET_POLL_REPLY_DELAY).
+ *             Further polls received while a reply is waiting, or within ARTNET_POLL_COALESCE_TIME
+ *             after it is sent, are answered by the same reply.  This also applies with no delay.
+ *             The waiting reply is sent by sendPendingPollReply, which is called when reading packets.
+ *             The caller must keep polling (reading packets or calling sendPendingPollReply from loop)
+ *             for the waiting reply to be sent.
+ * @param ms maximum delay, 0 to reply immediately
+ */
+   void setPollReplyDelay(uint16_t ms);
+/*!
+ * @brief send the reply to ArtPoll if it is waiting and its delay has passed
+ * @discussion Called by the readArtNetPacket and readArtNetPacketContents functions
+ *             (and their InputMode and LXWiFiArtNetNode versions) before the packet is read.
+ *             The contents functions only run when a packet is received, so a sketch reading packets
+ *             into a shared buffer should also call this from loop when a reply delay is set.
+ * @param wUDP pointer to UDP object to be used for sending UDP packet
+ * @return 1 if reply was sent
+ */
+   uint8_t sendPendingPollReply(UDP* wUDP);
+
+/*!
+ * @brief sets flag enabling synchronous output with ArtSync (enabled by default)
+ * @discussion After an ArtSync is received, ArtDMX is held until the next ArtSync.
+ *             Output reverts to immediate if no ArtSync is received for ARTNET_SYNC_TIMEOUT
+ *             or if more than one source is being merged.
+ * @param en enable flag
+ */
+   void enableArtSync(uint8_t en);
+
+/*!
+ * @brief synchronous output mode
+ * @return 1 if ArtDMX is being held for ArtSync
+ */
+   uint8_t syncMode ( void );
    
 /*!
  * @brief direct pointer to short name
@@ -267,25 +465,78 @@ class LXWiFiArtNet : public LXDMXWiFi {
    uint16_t readArtNetPacketContentsInputMode ( UDP* wUDP, uint16_t packetSize );
  /*!
  * @brief send Art-Net ArtDMX packet for dmx output from network
+ * @discussion Nothing is sent if the transmit buffer could not be allocated.
  * @param wUDP pointer to UDP object to be used for sending UDP packet
  * @param to_ip target address
  * @param interfaceAddr multicast unused for Art-Net
  */    
    void     sendDMX ( UDP* wUDP, IPAddress to_ip, IPAddress interfaceAddr );
+ /*!
+ * @brief send ArtDMX only if levels have changed or ARTNET_REFRESH_INTERVAL has passed
+ * @param wUDP pointer to UDP object to be used for sending UDP packet
+ * @param to_ip target address
+ * @param interfaceAddr multicast unused for Art-Net
+ * @return 1 if a packet was sent
+ */
+   uint8_t  sendDMXOnChange ( UDP* wUDP, IPAddress to_ip, IPAddress interfaceAddr );
+ /*!
+ * @brief minimum time between packets sent by sendDMXOnChange
+ * @param ms milliseconds
+ */
+   void     setMinimumSendInterval ( uint16_t ms );
+ /*!
+ * @brief send Art-Net ArtNzs packet with non-zero start code data
+ * @discussion data is sent directly and is not copied into the packet buffer
+ * @param wUDP pointer to UDP object to be used for sending UDP packet
+ * @param to_ip target address
+ * @param start_code 0x01 to 0xff excluding RDM start code 0xcc (not sent if 0x00 or 0xcc)
+ * @param data slot data following the start code
+ * @param slots 1 to 512
+ */
+   void     sendNzs ( UDP* wUDP, IPAddress to_ip, uint8_t start_code, uint8_t* data, uint16_t slots );
+ /*!
+ * @brief send Art-Net ArtTimeCode packet
+ * @param wUDP pointer to UDP object to be used for sending UDP packet
+ * @param to_ip target address
+ * @param hours 0-23
+ * @param minutes 0-59
+ * @param seconds 0-59
+ * @param frames 0-29 depending on type
+ * @param type ARTNET_TIMECODE_FILM, _EBU, _DF or _SMPTE
+ * @param stream_id master timecode stream, 0 for the default stream
+ */
+   void     sendTimeCode ( UDP* wUDP, IPAddress to_ip, uint8_t hours, uint8_t minutes, uint8_t seconds,
+                           uint8_t frames, uint8_t type, uint8_t stream_id = 0 );
    
 /*!
  * @brief send Art-Net ArtPoll to broadcast address
  * @param eUDP UDP* to be used for sending UDP packet
- * @discussion does nothing if broadcast address is undefined
+ * @discussion does nothing if broadcast address is undefined,
+ *             sent to 255.255.255.255 if there is no subnet broadcast address
  */ 
    void     send_art_poll( UDP* eUDP );
  /*!
  * @brief send ArtPoll Reply packet for dmx output from network
  * @discussion If broadcast address is defined by passing subnet to constructor, reply is broadcast
  *             Otherwise, reply is unicast to remoteIP belonging to the sender of the poll
+ *             One reply is sent for each BindIndex.  A reply describes up to ARTNET_PORTS_PER_REPLY
+ *             consecutive ports from the port list that share the same Net and Sub-Net.
  * @param wUDP pointer to UDP object to be used for sending UDP packet
  */  
    void     send_art_poll_reply ( UDP* wUDP, uint8_t mode = ARTPOLL_OUTPUT_MODE );
+
+ /*!
+ * @brief add a universe to the ports described by this instance's ArtPollReply
+ * @discussion This instance is always the first port.  LXWiFiArtNetNode adds its universes automatically.
+ *             A port can only belong to one list.
+ * @param port LXWiFiArtNet for another universe
+ */
+   void     addPort ( LXWiFiArtNet* port );
+ /*!
+ * @brief next port in list of ports sent in ArtPollReply
+ * @return pointer to LXWiFiArtNet or NULL if this is the last port
+ */
+   LXWiFiArtNet* nextPort ( void );
    
   /*!
  * @brief send ArtIpProgReply packet for dmx output from network
@@ -295,13 +546,14 @@ class LXWiFiArtNet : public LXDMXWiFi {
    void     send_art_ipprog_reply ( UDP* wUDP );
    
 /*!
- * @brief send ArtTOD packet for dmx output from network
- * @discussion 
+ * @brief send ArtTodData packets for dmx output from network
+ * @discussion The table is sent in blocks of up to ARTNET_TOD_MAX_UIDS, numbered by BlockCount.
+ *             UIDs are written directly from todata.
  * @param wUDP		pointer to UDP object to be used for sending UDP packet
  * @param todata	pointer to TOD array of 6 byte UIDs
  * @param ucount	number of 6 byte UIDs contained in todata
  */    
-   void     send_art_tod ( UDP* wUDP, uint8_t* todata, uint8_t ucount );
+   void     send_art_tod ( UDP* wUDP, uint8_t* todata, uint16_t ucount );
    
 /*!
  * @brief send ArtRDM packet
@@ -311,6 +563,23 @@ class LXWiFiArtNet : public LXDMXWiFi {
  * @param toa		IPAddress to send UDP ArtRDM packet    
  */ 
    void send_art_rdm ( UDP* wUDP, uint8_t* rdmdata, IPAddress toa );
+
+/*!
+ * @brief send ArtRdmSub packet(s)
+ * @discussion Get and SetResponse carry no data.  Set and GetResponse carry one 16 bit value
+ *             per sub-device.  More than ARTNET_RDM_SUB_MAX_COUNT values are split into
+ *             several packets with consecutive ranges of sub-devices.
+ * @param wUDP			pointer to UDP object to be used for sending UDP packet
+ * @param toa			IPAddress to send UDP ArtRdmSub packet
+ * @param uid			6 byte UID of the device
+ * @param command_class	ARTNET_RDM_SUB_GET, _GET_RESPONSE, _SET or _SET_RESPONSE
+ * @param pid			RDM parameter ID
+ * @param sub_device	first sub-device
+ * @param sub_count		number of sub-devices
+ * @param data			packed 16 bit big-endian values, one per sub-device (or NULL if none)
+ */ 
+   void send_art_rdm_sub ( UDP* wUDP, IPAddress toa, uint8_t* uid, uint8_t command_class,
+                           uint16_t pid, uint16_t sub_device, uint16_t sub_count, uint8_t* data );
    
 /*!
  * @brief Function called when ArtAddress packet is received
@@ -344,6 +613,40 @@ class LXWiFiArtNet : public LXDMXWiFi {
 	* @discussion callback has pointer to RDM payload
 	*/
    void setArtCommandCallback(ArtNetDataRecvCallback callback);
+
+   /*!
+	* @brief function callback when ArtRdmSub is received
+	* @discussion callback has the UID, command class, parameter ID, range of sub-devices
+	*             and pointer to packed 16 bit big-endian values (one per sub-device for Set and GetResponse)
+	*/
+   void setArtRdmSubCallback(ArtRdmSubRecvCallback callback);
+
+   /*!
+	* @brief function callback when ArtNzs is received for this universe
+	* @discussion callback has start code, pointer to slot data and number of slots
+	*/
+   void setArtNzsCallback(ArtNzsRecvCallback callback);
+
+   /*!
+	* @brief function callback when ArtTimeCode is received
+	* @discussion callback is called as soon as the packet is read, with the time, type and stream ID
+	*/
+   void setArtTimeCodeCallback(ArtTimeCodeRecvCallback callback);
+
+ /*!
+ * @brief start code of last ArtNzs received
+ * @return start code or zero if no ArtNzs has been received
+ */
+   uint8_t  nzsStartCode ( void );
+ /*!
+ * @brief number of slots in last ArtNzs received
+ */
+   uint16_t nzsSlots ( void );
+ /*!
+ * @brief direct pointer to data of last ArtNzs received (kept apart from dmx levels)
+ * @return uint8_t* to slot data or NULL if no ArtNzs has been received
+ */
+   uint8_t* nzsData ( void );
    
 /*!
  * @brief Function called when ArtIpProg packet is received
@@ -392,9 +695,13 @@ class LXWiFiArtNet : public LXDMXWiFi {
 */	uint16_t  _packetSize;
 
 /*!
-* @brief array that holds contents of outgoing ArtPollReply packet
+* @brief contents of outgoing ArtPollReply packet for this instance, allocated on first use
 */	
-	static uint8_t _reply_buffer[ARTNET_REPLY_SIZE];
+	uint8_t*  _reply_buffer;
+/// _reply_buffer must be rebuilt by initializePollReply before it is sent
+	uint8_t   _reply_dirty;
+/// state described by NodeReport text in _reply_buffer, source count or ARTNET_REPORT_INPUT
+	uint8_t   _reply_report;
 	
 /*!
 * @brief string containing short name of node for poll reply
@@ -407,18 +714,68 @@ class LXWiFiArtNet : public LXDMXWiFi {
 	char _long_name[ARTNET_LONG_NAME_LENGTH];
 	
 /*!
-* @brief buffers that hold DMX data from source a, source b and HTP composite
-* @discussion data is read into _dmx_buffer_a or _dmx_buffer_b depending on the
-*             IP address of the sender, at the same time it is merged into _dmx_buffer_c.
+* @brief buffer that holds the HTP composite of all sources
+* @discussion data is read into the buffer of the source matching the IP address of
+*             the sender, at the same time it is merged into _dmx_buffer_c.
+*             While there is only a single source, its data is copied directly into
+*             _dmx_buffer_c and the source has no buffer.
 */
-  	uint8_t   _dmx_buffer_a[DMX_UNIVERSE_SIZE];
-  	uint8_t   _dmx_buffer_b[DMX_UNIVERSE_SIZE];
   	uint8_t   _dmx_buffer_c[DMX_UNIVERSE_SIZE];
+
+/// senders of ArtDMX in the order they were first received
+  	ArtNetDMXSource _sources[ARTNET_MAX_SOURCES];
+/// number of active entries in _sources
+  	uint8_t   _source_count;
+/// maximum number of sources, further senders are ignored
+  	uint8_t   _max_sources;
+/*!
+* @brief ArtDMX packet for sendDMX, allocated on first use
+* @discussion separate from _packet_buffer so that reading packets does not disturb
+*             outgoing data.  The constant part of the header is written once.
+*/
+  	uint8_t*  _tx_buffer;
+/// _tx_buffer has been changed since the last sendDMX
+  	uint8_t   _tx_changed;
+/// levels of the last ArtDMX sent, allocated when dmxData() is first called
+  	uint8_t*  _tx_last;
+/// number of slots in the last ArtDMX sent
+  	int       _tx_slots;
+/// time the last ArtDMX was sent
+  	unsigned long _last_send;
+/// minimum time between packets sent by sendDMXOnChange
+  	uint16_t  _min_send_interval;
+
+/// nodes found in ArtPollReply (see discovery())
+  	LXWiFiArtNetDiscovery* _discovery;
+/// flag indicating _discovery was created by this instance
+  	uint8_t   _owns_discovery;
+/// enable flag for unicast to subscribers
+  	uint8_t   _subscriber_unicast;
+/// time ArtPoll was last sent by sendDMX
+  	unsigned long _last_poll;
+
+/// next universe described in ArtPollReply (see addPort)
+  	LXWiFiArtNet* _next_port;
+
+/// HTP of all sources but the sender of the current packet, allocated for 3 or more sources
+  	uint8_t*  _merge_buffer;
+
+/// merged ArtDMX waiting for ArtSync, allocated only in sync mode
+  	uint8_t*  _sync_buffer;
+/// number of slots in _sync_buffer
+  	uint16_t  _sync_slots;
+/// _sync_buffer has data not yet copied to _dmx_buffer_c
+  	uint8_t   _sync_pending;
+/// enable flag for ArtSync
+  	uint8_t   _sync_enabled;
+/// time last ArtSync was received
+  	unsigned long _last_sync;
   	
 /// number of slots/address/channels
   	int       _dmx_slots;
-  	int       _dmx_slots_a;
-  	int       _dmx_slots_b;
+
+/// slots of _dmx_buffer_c changed by the last ArtDMX packet
+  	LXDMXChanges _changes;
 
 /// high nibble subnet, low nibble universe
   	uint8_t   _portaddress_lo;
@@ -429,7 +786,23 @@ class LXWiFiArtNet : public LXDMXWiFi {
 /// sequence number for sending ArtDMX packets
   	uint16_t   _poll_reply_counter;
 /// enable flag for sending poll replies
-    uint8_t    _poll_reply_enabled;	
+    uint8_t    _poll_reply_enabled;
+/// input port disabled by ArtInput
+    uint8_t    _input_disabled;
+/// reply to ArtPoll is waiting to be sent
+    uint8_t    _poll_reply_pending;
+/// ARTPOLL_OUTPUT_MODE or ARTPOLL_INPUT_MODE for waiting reply
+    uint8_t    _poll_reply_mode;
+/// destination of waiting reply
+    IPAddress  _poll_reply_to;
+/// time ArtPoll was received
+    unsigned long _poll_reply_time;
+/// random delay for waiting reply
+    uint16_t   _poll_reply_wait;
+/// time the last reply to ArtPoll was sent
+    unsigned long _poll_reply_sent;
+/// maximum random delay
+    uint16_t   _poll_reply_delay;	
 
 /// address included in poll reply 	
   	IPAddress _my_address;
@@ -437,10 +810,10 @@ class LXWiFiArtNet : public LXDMXWiFi {
   	IPAddress _my_subnetmask;
 /// if subnet is supplied in constructor, holds address to broadcast poll replies
   	IPAddress _broadcast_address;
-/// first sender of an ArtDMX packet
-  	IPAddress _dmx_sender_a;
-/// second sender of an ArtDMX packet (3rd and subsequent senders ignored until cancelMerge)
-  	IPAddress _dmx_sender_b;
+/// count of packets missing from sequence
+  	uint32_t  _sequence_gaps;
+/// count of packets discarded as late or out of order
+  	uint32_t  _sequence_reorders;
 
 /// flag factory boot, network programmable
 	uint8_t _status1;  	
@@ -466,11 +839,33 @@ class LXWiFiArtNet : public LXDMXWiFi {
    */
   	ArtNetDataRecvCallback _art_rdm_callback;
   	
+  	/*!
+    * @brief Pointer to ArtRdmSub received callback function
+   */
+  	ArtRdmSubRecvCallback _art_rdm_sub_callback;
+  	
   	/*!
     * @brief Pointer to art command packet received callback function
    */
   	ArtNetDataRecvCallback _art_cmd_callback;
   	
+  	/*!
+    * @brief Pointer to ArtNzs received callback function
+   */
+  	ArtNzsRecvCallback _art_nzs_callback;
+  	
+  	/*!
+    * @brief Pointer to ArtTimeCode received callback function
+   */
+  	ArtTimeCodeRecvCallback _art_timecode_callback;
+
+/// data of last ArtNzs, allocated when first ArtNzs is received
+  	uint8_t*  _nzs_buffer;
+/// number of slots in _nzs_buffer
+  	uint16_t  _nzs_slots;
+/// start code of last ArtNzs
+  	uint8_t   _nzs_start_code;
+  	
   	/*!
     * @brief Pointer to artIpProg received callback function
    */
@@ -487,10 +882,108 @@ class LXWiFiArtNet : public LXDMXWiFi {
 */
   	uint16_t  parse_header        ( void );	
 /*!
+* @brief handle a packet in output mode
+* @param opcode returned by parse_header
+* @return opcode, ARTNET_ART_DMX if the output changed, or ARTNET_NOP if the packet was not used
+*/
+  	uint16_t  parse_opcode        ( UDP* wUDP, uint16_t opcode, uint16_t packetSize );
+/*!
+* @brief utility for parsing ArtDMX packets
+* @discussion header is assumed to be already checked by parse_header
+* @return ARTNET_ART_DMX if packet contained dmx for this universe, otherwise ARTNET_NOP
+*/
+  	uint16_t  parse_art_dmx       ( UDP* wUDP, uint16_t packetSize );
+/*!
+* @brief number of slots to write when merging a packet with t_slots
+* @discussion larger than t_slots when the universe is shrinking so trailing slots are zeroed
+*/
+  	uint16_t  merge_slots         ( uint16_t t_slots );
+/*!
+* @brief check the sequence of an ArtDMX packet against the last from the same sender
+* @discussion updates last_sequence and the gap/reorder counts
+* @return 1 if packet should be used, 0 if it is late or out of order
+*/
+  	uint8_t   check_sequence      ( uint8_t* last_sequence );
+/*!
+* @brief utility for parsing ArtNzs packets
+* @discussion header is assumed to be already checked by parse_header
+* @return ARTNET_ART_NZS if packet contained data for this universe, otherwise ARTNET_NOP
+*/
+  	uint16_t  parse_art_nzs       ( uint16_t packetSize );
+/*!
+* @brief utility for parsing ArtTimeCode packets
+* @return ARTNET_ART_TIMECODE if the callback was called, otherwise ARTNET_NOP
+*/
+  	uint16_t  parse_art_timecode  ( uint16_t packetSize );
+/*!
+* @brief utility for parsing ArtSync packets
+* @return ARTNET_ART_DMX if held ArtDMX was copied to output, otherwise ARTNET_NOP
+*/
+  	uint16_t  parse_art_sync      ( UDP* wUDP );
+/*!
+* @brief leave sync mode, copying any held ArtDMX to output
+*/
+  	void      end_sync            ( void );
+/*!
+* @brief transmit buffer, allocating and writing the ArtDMX header if needed
+*/
+  	uint8_t*  tx_buffer           ( void );
+/*!
+* @brief outgoing levels or slot count differ from the last ArtDMX sent
+*/
+  	uint8_t   tx_changed          ( void );
+/*!
+* @brief buffer that ArtDMX is merged into, _dmx_buffer_c or _sync_buffer
+*/
+  	uint8_t*  merge_target        ( void );
+/*!
+* @brief change record for merge_target, NULL in sync mode
+*/
+  	LXDMXChanges* merge_changes   ( void );
+/*!
+* @brief find or add the source for an ArtDMX packet
+* @return index in _sources or ARTNET_NO_SOURCE if all sources are in use
+*/
+  	uint8_t   source_for_address  ( IPAddress address );
+/*!
+* @brief remove sources whose last packet is older than ARTNET_SOURCE_TIMEOUT
+* @param current sender of packet being read, never removed
+*/
+  	void      expire_sources      ( IPAddress current );
+/*!
+* @brief result of an ArtDMX packet that was not merged
+* @return ARTNET_ART_DMX if expire_sources changed the output, otherwise ARTNET_NOP
+*/
+  	uint16_t  rejected_dmx_result ( void );
+/*!
+* @brief remove a source, freeing its buffer
+* @discussion call update_merge_output after removing sources
+*/
+  	void      remove_source       ( uint8_t index );
+/*!
+* @brief rebuild _dmx_buffer_c from the remaining sources after removing sources
+*/
+  	void      update_merge_output ( void );
+/*!
+* @brief test if address is limited broadcast or the broadcast address of the local subnet
+*/
+  	uint8_t   is_broadcast        ( IPAddress address );
+/*!
 * @brief utility for parsing ArtAddress packets
-* @return opcode in case command changes dmx data
+* @discussion applies to the ports selected by BindIndex
+* @return ARTNET_ART_DMX if output was cleared, ARTNET_NOP if no ports match BindIndex, otherwise ARTNET_ART_ADDRESS
 */
    uint16_t  parse_art_address   ( UDP* wUDP );
+/*!
+* @brief drop all sources except sender (ArtAddress cancel merge)
+*/
+   void      cancel_merge        ( IPAddress sender );
+/*!
+* @brief utility for parsing ArtInput packets
+* @param packetSize size of received packet, shorter than ARTNET_INPUT_SIZE is ignored
+* @return ARTNET_ART_INPUT if the packet was for this node's ports, otherwise ARTNET_NOP
+*/
+   uint16_t  parse_art_input     ( uint16_t packetSize );
    
 /*!
 * @brief utility for parsing ArtIPProg packets
@@ -499,24 +992,33 @@ class LXWiFiArtNet : public LXDMXWiFi {
    
 /*!
 * @brief utility for parsing ArtTODRequest packets
+* @param packetSize size of received packet, at least 25
+*/     
+   uint16_t parse_art_tod_request( uint16_t packetSize );
+/*!
+* @brief utility for parsing ArtTODControl packets
 */     
-   uint16_t parse_art_tod_request( UDP* wUDP );
-   uint16_t parse_art_tod_control( UDP* wUDP );
+   uint16_t parse_art_tod_control( void );
    
 /*!
 * @brief utility for parsing ArtRDM packets
 */     
-   uint16_t parse_art_rdm( UDP* wUDP );
+   uint16_t parse_art_rdm( void );
+   
+/*!
+* @brief utility for parsing ArtRdmSub packets
+*/     
+   uint16_t parse_art_rdm_sub( uint16_t packetSize );
    
 /*!
 * @brief utility for parsing ArtCommand packets
 */   
-   void parse_art_cmd( UDP* wUDP );
+   void parse_art_cmd( void );
    
 /*!
-* @brief calls art_poll_reply_callback
+* @brief records reply in discovery() and calls art_poll_reply_callback
 */     
-   uint16_t parse_art_poll_reply( UDP* wUDP );
+   uint16_t parse_art_poll_reply( uint16_t packetSize );
    
 /*!
 * @brief initialize data structures
@@ -537,6 +1039,32 @@ class LXWiFiArtNet : public LXDMXWiFi {
 * @brief initialize poll reply buffer
 */
    void  initializePollReply  ( void );
+/*!
+* @brief reply to ArtPoll now or after a random delay
+*/
+   void  schedule_poll_reply  ( UDP* wUDP, uint8_t mode );
+/*!
+* @brief send one ArtPollReply for each bind index
+*/
+   void  send_poll_replies    ( UDP* wUDP, IPAddress a, uint8_t mode );
+/*!
+* @brief number of ports described by the reply starting at port
+* @discussion ports in one reply share net and subnet (see send_poll_replies)
+*/
+   uint8_t  ports_in_reply    ( LXWiFiArtNet* port );
+/*!
+* @brief first port of the reply numbered bind_index by send_poll_replies
+* @return NULL if there are fewer replies
+*/
+   LXWiFiArtNet* port_for_bind_index ( uint8_t bind_index );
+/*!
+* @brief poll reply buffer, allocating it if needed
+*/
+   uint8_t*  reply_buffer     ( void );
+/*!
+* @brief rebuild poll reply if needed and update NodeReport
+*/
+   void  update_poll_reply    ( uint8_t mode );
    
 };
 
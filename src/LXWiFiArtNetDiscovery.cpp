@@ -0,0 +1,191 @@
+/**************************************************************************/
+/*!
+    @file     LXWiFiArtNetDiscovery.cpp
+    @author   Claude Heintz
+    @license  BSD (see LXDMXWiFi.h)
+    @copyright 2026 by Claude Heintz All Rights Reserved
+
+    Art-Net(TM) Designed by and Copyright Artistic Licence Holdings Ltd.
+
+    Directory of Art-Net nodes found by ArtPoll.
+
+    @section  HISTORY
+
+    v1.0 - First release
+*/
+/**************************************************************************/
+
+#include "LXWiFiArtNetDiscovery.h"
+
+LXWiFiArtNetDiscovery::LXWiFiArtNetDiscovery ( IPAddress address, IPAddress broadcast_address )
+{
+	_node_count = 0;
+	_my_address = address;
+	_broadcast_address = broadcast_address;
+	update_tables();
+}
+
+void LXWiFiArtNetDiscovery::setAddresses ( IPAddress address, IPAddress broadcast_address ) {
+	_my_address = address;
+	_broadcast_address = broadcast_address;
+}
+
+void LXWiFiArtNetDiscovery::update ( void ) {
+	expire_nodes();
+}
+
+/*
+  tables are only rebuilt when a node is added or its ports change
+*/
+uint8_t LXWiFiArtNetDiscovery::readPollReply ( uint8_t* packet, uint16_t packetSize ) {
+	if ( packetSize < 212 ) {				// through BindIndex
+		return 0;
+	}
+	IPAddress node(packet[10], packet[11], packet[12], packet[13]);
+	if ( node == _my_address ) {
+		return 0;
+	}
+	uint8_t bind_index = packet[211];
+	if ( bind_index == 0 ) {				// Art-Net 3 and earlier
+		bind_index = 1;
+	}
+
+	uint16_t output[ARTNET_PORTS_PER_REPLY];
+	uint16_t input[ARTNET_PORTS_PER_REPLY];
+	uint8_t ports = packet[173];
+	if (( ports > ARTNET_PORTS_PER_REPLY ) || packet[172] ) {
+		ports = ARTNET_PORTS_PER_REPLY;
+	}
+	uint16_t net_subnet = ((packet[18] & 0x7f) << 8) | ((packet[19] & 0x0f) << 4);
+	for (int p=0; p<ARTNET_PORTS_PER_REPLY; p++) {
+		output[p] = ARTNET_NO_PORT;
+		input[p] = ARTNET_NO_PORT;
+		if ( p < ports ) {
+			if ( packet[174+p] & 0x80 ) {
+				output[p] = net_subnet | (packet[190+p] & 0x0f);
+			}
+			if ( packet[174+p] & 0x40 ) {
+				input[p] = net_subnet | (packet[186+p] & 0x0f);
+			}
+		}
+	}
+
+	ArtNetNodeEntry* entry = nodeForAddress(node, bind_index);
+	uint8_t changed = 0;
+	if ( entry == NULL ) {
+		uint8_t index = _node_count;
+		if ( index < ARTNET_DISCOVERY_MAX_NODES ) {
+			_node_count++;
+		} else {							// directory is full, replace the oldest
+			unsigned long now = millis();
+			index = 0;
+			for (int k=1; k<_node_count; k++) {
+				if ( now - _nodes[k].last_reply > now - _nodes[index].last_reply ) {
+					index = k;
+				}
+			}
+		}
+		entry = &_nodes[index];
+		entry->address = node;
+		entry->bind_index = bind_index;
+		changed = 1;
+	} else {
+		changed = ( memcmp(entry->output, output, sizeof(output)) != 0 );
+	}
+	memcpy(entry->output, output, sizeof(output));
+	memcpy(entry->input, input, sizeof(input));
+	entry->style = packet[200];
+	memcpy(entry->short_name, &packet[26], ARTNET_SHORT_NAME_LENGTH);
+	entry->short_name[ARTNET_SHORT_NAME_LENGTH-1] = 0;
+	entry->last_reply = millis();
+
+	if ( changed ) {
+		update_tables();
+	}
+	return 1;
+}
+
+uint8_t LXWiFiArtNetDiscovery::numberOfNodes ( void ) {
+	return _node_count;
+}
+
+ArtNetNodeEntry* LXWiFiArtNetDiscovery::nodeAtIndex ( uint8_t index ) {
+	if ( index < _node_count ) {
+		return &_nodes[index];
+	}
+	return NULL;
+}
+
+ArtNetNodeEntry* LXWiFiArtNetDiscovery::nodeForAddress ( IPAddress address, uint8_t bind_index ) {
+	uint8_t index = _address_table[address[3]];
+	while ( index != ARTNET_DISCOVERY_NO_NODE ) {
+		if (( _nodes[index].address == address ) && ( _nodes[index].bind_index == bind_index )) {
+			return &_nodes[index];
+		}
+		index = _address_next[index];
+	}
+	return NULL;
+}
+
+uint8_t LXWiFiArtNetDiscovery::firstConsumer ( uint16_t port_address ) {
+	uint8_t consumer = _consumer_table[port_address & 0xff];
+	if (( consumer != ARTNET_DISCOVERY_NO_NODE ) &&
+	    ( _nodes[consumer / ARTNET_PORTS_PER_REPLY].output[consumer % ARTNET_PORTS_PER_REPLY] != port_address )) {
+		consumer = nextConsumer(consumer, port_address);
+	}
+	return consumer;
+}
+
+uint8_t LXWiFiArtNetDiscovery::nextConsumer ( uint8_t consumer, uint16_t port_address ) {
+	consumer = _consumer_next[consumer];
+	while ( consumer != ARTNET_DISCOVERY_NO_NODE ) {
+		if ( _nodes[consumer / ARTNET_PORTS_PER_REPLY].output[consumer % ARTNET_PORTS_PER_REPLY] == port_address ) {
+			break;
+		}
+		consumer = _consumer_next[consumer];
+	}
+	return consumer;
+}
+
+IPAddress LXWiFiArtNetDiscovery::consumerAddress ( uint8_t consumer ) {
+	return _nodes[consumer / ARTNET_PORTS_PER_REPLY].address;
+}
+
+/*
+  chains are built in reverse so that they are in directory order
+*/
+void LXWiFiArtNetDiscovery::update_tables ( void ) {
+	memset(_address_table, ARTNET_DISCOVERY_NO_NODE, 256);
+	memset(_consumer_table, ARTNET_DISCOVERY_NO_NODE, 256);
+	for (int n=_node_count-1; n>=0; n--) {
+		uint8_t lo = _nodes[n].address[3];
+		_address_next[n] = _address_table[lo];
+		_address_table[lo] = n;
+		for (int p=ARTNET_PORTS_PER_REPLY-1; p>=0; p--) {
+			uint16_t port_address = _nodes[n].output[p];
+			if ( port_address != ARTNET_NO_PORT ) {
+				uint8_t consumer = n * ARTNET_PORTS_PER_REPLY + p;
+				_consumer_next[consumer] = _consumer_table[port_address & 0xff];
+				_consumer_table[port_address & 0xff] = consumer;
+			}
+		}
+	}
+}
+
+void LXWiFiArtNetDiscovery::expire_nodes ( void ) {
+	unsigned long now = millis();
+	uint8_t removed = 0;
+	int k = 0;
+	while ( k < _node_count ) {
+		if ( now - _nodes[k].last_reply > ARTNET_NODE_TIMEOUT ) {
+			_node_count--;
+			_nodes[k] = _nodes[_node_count];
+			removed = 1;
+		} else {
+			k++;
+		}
+	}
+	if ( removed ) {
+		update_tables();
+	}
+}
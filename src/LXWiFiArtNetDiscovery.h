@@ -0,0 +1,157 @@
+/* LXWiFiArtNetDiscovery.h
+   Copyright 2026 by Claude Heintz Design
+   see LXDMXWiFi.h for LICENSE
+
+	Art-Net(TM) Designed by and Copyright Artistic Licence Holdings Ltd.
+*/
+
+#ifndef LXWIFIARTNETDISCOVERY_H
+#define LXWIFIARTNETDISCOVERY_H
+
+#include <Arduino.h>
+#include "LXDMXWiFi.h"
+#include "LXWiFiArtNet.h"
+
+#define ARTNET_DISCOVERY_MAX_NODES 32
+#define ARTNET_DISCOVERY_NO_NODE 0xff
+#define ARTNET_NODE_TIMEOUT 10000
+#define ARTNET_NO_PORT 0xffff
+
+/*!
+* @brief a node (or bound device of a node) found in ArtPollReply
+* @discussion Ports without input or output are ARTNET_NO_PORT.
+*/
+typedef struct {
+	IPAddress     address;
+	uint8_t       bind_index;
+	uint8_t       style;
+	uint16_t      output[ARTNET_PORTS_PER_REPLY];
+	uint16_t      input[ARTNET_PORTS_PER_REPLY];
+	char          short_name[ARTNET_SHORT_NAME_LENGTH];
+	unsigned long last_reply;
+} ArtNetNodeEntry;
+
+/*!
+*  @class LXWiFiArtNetDiscovery
+*  @abstract
+*     LXWiFiArtNetDiscovery keeps a directory of the Art-Net nodes replying to ArtPoll.
+*
+*     Each ArtPollReply (one per node and BindIndex) is an entry in the directory.
+*     Entries are removed when no reply has been received for ARTNET_NODE_TIMEOUT.
+*     Entries are found by IP address through a table indexed by the last byte of the address.
+*     The output ports consuming a Port-Address are found through a table indexed by
+*     the low byte (sub-net/universe) of the Port-Address, like LXWiFiArtNetNode.
+*
+*     LXWiFiArtNet uses a directory to unicast ArtDMX (see LXWiFiArtNet::enableSubscriberUnicast).
+*     The directory does not poll, ArtPoll is sent by LXWiFiArtNet::sendDMX.
+*/
+class LXWiFiArtNetDiscovery {
+
+  public:
+/*!
+* @brief constructor
+* @param address of this node, replies from this address are ignored
+* @param broadcast_address of the local subnet
+*/
+	LXWiFiArtNetDiscovery  ( IPAddress address, IPAddress broadcast_address );
+
+/*!
+* @brief set addresses after a change to the local address
+*/
+	void setAddresses ( IPAddress address, IPAddress broadcast_address );
+
+/*!
+* @brief remove nodes that have not replied
+* @discussion call regularly from loop or before using the directory
+*/
+	void update ( void );
+
+/*!
+* @brief add or refresh the entry for an ArtPollReply
+* @param packet contents of Art-Net packet with ArtPollReply opcode
+* @param packetSize size of packet
+* @return 1 if the packet was recorded in the directory
+*/
+	uint8_t readPollReply ( uint8_t* packet, uint16_t packetSize );
+
+/*!
+* @brief number of entries in the directory
+*/
+	uint8_t numberOfNodes ( void );
+
+/*!
+* @brief entry in directory
+* @param index 0 to numberOfNodes()-1
+* @return pointer to entry or NULL
+*/
+	ArtNetNodeEntry* nodeAtIndex ( uint8_t index );
+
+/*!
+* @brief entry for an address
+* @param address IP address of node
+* @param bind_index of device, 1 is the root device
+* @return pointer to entry or NULL
+*/
+	ArtNetNodeEntry* nodeForAddress ( IPAddress address, uint8_t bind_index = 1 );
+
+/*!
+* @brief first output port consuming a Port-Address
+* @discussion iterate with nextConsumer, for example
+*             for (uint8_t c = firstConsumer(u); c != ARTNET_DISCOVERY_NO_NODE; c = nextConsumer(c, u))
+* @param port_address complete 15 bit Port-Address
+* @return consumer reference or ARTNET_DISCOVERY_NO_NODE
+*/
+	uint8_t firstConsumer ( uint16_t port_address );
+
+/*!
+* @brief next output port consuming a Port-Address
+* @param consumer reference from firstConsumer or nextConsumer
+* @param port_address complete 15 bit Port-Address
+* @return consumer reference or ARTNET_DISCOVERY_NO_NODE
+*/
+	uint8_t nextConsumer ( uint8_t consumer, uint16_t port_address );
+
+/*!
+* @brief IP address of the node with a consuming output port
+* @param consumer reference from firstConsumer or nextConsumer
+*/
+	IPAddress consumerAddress ( uint8_t consumer );
+
+  private:
+/// entries in the order they were found
+	ArtNetNodeEntry _nodes[ARTNET_DISCOVERY_MAX_NODES];
+/// number of entries
+	uint8_t _node_count;
+
+/// address of this node
+	IPAddress _my_address;
+/// broadcast address of the local subnet
+	IPAddress _broadcast_address;
+
+/*!
+* @brief index of first entry for each last byte of IP address
+* @discussion entries sharing the last byte are chained through _address_next
+*/
+	uint8_t _address_table[256];
+	uint8_t _address_next[ARTNET_DISCOVERY_MAX_NODES];
+
+/*!
+* @brief first output port for each low byte of Port-Address
+* @discussion a consumer reference is node index * ARTNET_PORTS_PER_REPLY + port
+*             output ports sharing the low byte are chained through _consumer_next
+*/
+	uint8_t _consumer_table[256];
+	uint8_t _consumer_next[ARTNET_DISCOVERY_MAX_NODES * ARTNET_PORTS_PER_REPLY];
+
+/*!
+* @brief rebuild address and Port-Address tables after entries are added, removed or changed
+*/
+	void update_tables ( void );
+
+/*!
+* @brief remove entries whose last reply is older than ARTNET_NODE_TIMEOUT
+*/
+	void expire_nodes ( void );
+};
+
+#endif // ifndef LXWIFIARTNETDISCOVERY_H
@@ -0,0 +1,254 @@
+/**************************************************************************/
+/*!
+    @file     LXWiFiArtNetNode.cpp
+    @author   Claude Heintz
+    @license  BSD (see LXDMXWiFi.h)
+    @copyright 2026 by Claude Heintz All Rights Reserved
+
+    Art-Net(TM) Designed by and Copyright Artistic Licence Holdings Ltd.
+
+    Receives Art-Net for multiple universes sharing one packet buffer.
+
+    @section  HISTORY
+
+    v1.0 - First release
+    v1.1 - ArtSync is passed to all universes
+    v1.2 - ArtNzs is passed to the universe matching its Port-Address
+    v1.3 - ArtPollReply describes all universes
+    v1.4 - sends delayed ArtPollReply
+    v1.5 - other opcodes are handled without parsing the header again
+    v1.6 - ArtTodRequest, ArtTodControl, ArtRdm and ArtAddress reach the universes they address
+*/
+/**************************************************************************/
+
+#include "LXWiFiArtNetNode.h"
+
+LXWiFiArtNetNode::LXWiFiArtNetNode ( IPAddress address, IPAddress subnet_mask )
+{
+	_packet_buffer = (uint8_t*) malloc(ARTNET_BUFFER_MAX);
+	for (int n=0; n<ARTNET_BUFFER_MAX; n++) {
+		_packet_buffer[n] = 0;
+	}
+	_packetSize = 0;
+	_my_address = address;
+	_my_subnetmask = subnet_mask;
+	_universe_count = 0;
+	_received_index = ARTNET_NODE_NO_UNIVERSE;
+	_sync_received = 0;
+	for (int n=0; n<ARTNET_NODE_MAX_UNIVERSES; n++) {
+		_universes[n] = NULL;
+	}
+	updateUniverseTable();
+}
+
+LXWiFiArtNetNode::~LXWiFiArtNetNode ( void )
+{
+	for (int n=0; n<_universe_count; n++) {
+		delete _universes[n];
+	}
+	free(_packet_buffer);
+}
+
+LXWiFiArtNet* LXWiFiArtNetNode::addUniverse ( uint16_t u ) {
+	if ( _universe_count >= ARTNET_NODE_MAX_UNIVERSES ) {
+		return NULL;
+	}
+	LXWiFiArtNet* universe = new LXWiFiArtNet(_my_address, _my_subnetmask, _packet_buffer);
+	universe->setUniverse(u);
+	if ( _universe_count ) {
+		_universes[0]->addPort(universe);		// first universe sends ArtPollReply for all
+	}
+	_universes[_universe_count] = universe;
+	_universe_count++;
+	updateUniverseTable();
+	return universe;
+}
+
+uint8_t LXWiFiArtNetNode::numberOfUniverses ( void ) {
+	return _universe_count;
+}
+
+LXWiFiArtNet* LXWiFiArtNetNode::universeAtIndex ( uint8_t index ) {
+	if ( index < _universe_count ) {
+		return _universes[index];
+	}
+	return NULL;
+}
+
+LXWiFiArtNet* LXWiFiArtNetNode::universeForPortAddress ( uint16_t u ) {
+	uint8_t index = indexForPortAddress(u & 0xff, (u >> 8) & 0x7f);
+	if ( index != ARTNET_NODE_NO_UNIVERSE ) {
+		return _universes[index];
+	}
+	return NULL;
+}
+
+LXWiFiArtNet* LXWiFiArtNetNode::receivedUniverse ( void ) {
+	if ( _received_index != ARTNET_NODE_NO_UNIVERSE ) {
+		return _universes[_received_index];
+	}
+	return NULL;
+}
+
+uint8_t LXWiFiArtNetNode::syncReceived ( void ) {
+	return _sync_received;
+}
+
+/*
+  chains are built in reverse so that the first universe added is found first
+  when two universes share the same Port-Address
+*/
+void LXWiFiArtNetNode::updateUniverseTable ( void ) {
+	for (int n=0; n<256; n++) {
+		_universe_table[n] = ARTNET_NODE_NO_UNIVERSE;
+	}
+	for (int n=_universe_count-1; n>=0; n--) {
+		uint8_t lo = _universes[n]->_portaddress_lo;
+		_universe_next[n] = _universe_table[lo];
+		_universe_table[lo] = n;
+	}
+}
+
+uint8_t LXWiFiArtNetNode::indexForPortAddress ( uint8_t lo, uint8_t hi ) {
+	uint8_t index = _universe_table[lo];
+	while ( index != ARTNET_NODE_NO_UNIVERSE ) {
+		if ( _universes[index]->_portaddress_hi == hi ) {
+			break;
+		}
+		index = _universe_next[index];
+	}
+	return index;
+}
+
+uint8_t* LXWiFiArtNetNode::packetBuffer( void ) {
+	return &_packet_buffer[0];
+}
+
+uint16_t LXWiFiArtNetNode::packetSize( void ) {
+	return _packetSize;
+}
+
+uint8_t LXWiFiArtNetNode::readDMXPacket ( UDP* wUDP ) {
+	_packetSize = 0;
+	uint16_t opcode = readArtNetPacket(wUDP);
+	if ( opcode == ARTNET_ART_DMX ) {
+		return RESULT_DMX_RECEIVED;
+	}
+	return RESULT_NONE;
+}
+
+uint8_t LXWiFiArtNetNode::readDMXPacketContents ( UDP* wUDP, uint16_t packetSize ) {
+	uint16_t opcode = readArtNetPacketContents(wUDP, packetSize);
+	if ( opcode == ARTNET_ART_DMX ) {
+		return RESULT_DMX_RECEIVED;
+	}
+	if (( opcode == ARTNET_ART_POLL ) || ( opcode == ARTNET_ART_NZS )) {
+		return RESULT_PACKET_COMPLETE;
+	}
+	return RESULT_NONE;
+}
+
+uint16_t LXWiFiArtNetNode::readArtNetPacket ( UDP* wUDP ) {
+	if ( _universe_count ) {
+		_universes[0]->sendPendingPollReply(wUDP);
+	}
+	int packetSize = wUDP->parsePacket();
+	uint16_t opcode = ARTNET_NOP;
+	_received_index = ARTNET_NODE_NO_UNIVERSE;
+	_sync_received = 0;
+	if ( packetSize > 0 ) {
+		_packetSize = wUDP->read(_packet_buffer, ARTNET_BUFFER_MAX);	//can return -1 in ESP32
+		if ( _packetSize > 0 ) {										//trap invalid returns
+			opcode = readArtNetPacketContents(wUDP, _packetSize);
+		}
+	}
+	return opcode;
+}
+
+/*
+  header is checked once using the first universe (all universes share _packet_buffer)
+  ArtDMX, ArtNzs, ArtTodControl and ArtRdm go directly to the universe found in the Port-Address table
+  ArtSync and ArtTodRequest (which lists up to 32 Port-Addresses) go to every universe
+  ArtAddress is handled by the first universe, which finds the ports by BindIndex
+  everything else is handled by the first universe
+*/
+uint16_t LXWiFiArtNetNode::readArtNetPacketContents ( UDP* wUDP, uint16_t packetSize ) {
+	_received_index = ARTNET_NODE_NO_UNIVERSE;
+	_sync_received = 0;
+	if ( _universe_count == 0 ) {
+		return ARTNET_NOP;
+	}
+	_universes[0]->sendPendingPollReply(wUDP);
+
+	uint16_t opcode = _universes[0]->parse_header();
+	if ( opcode == ARTNET_ART_DMX ) {
+		uint8_t index = indexForPortAddress(_packet_buffer[14], _packet_buffer[15]);
+		if ( index == ARTNET_NODE_NO_UNIVERSE ) {
+			return ARTNET_NOP;
+		}
+		opcode = _universes[index]->parse_art_dmx(wUDP, packetSize);
+		if ( opcode == ARTNET_ART_DMX ) {
+			_received_index = index;
+		}
+	} else if ( opcode == ARTNET_ART_NZS ) {
+		uint8_t index = indexForPortAddress(_packet_buffer[14], _packet_buffer[15]);
+		if ( index == ARTNET_NODE_NO_UNIVERSE ) {
+			return ARTNET_NOP;
+		}
+		opcode = _universes[index]->parse_art_nzs(packetSize);
+		if ( opcode == ARTNET_ART_NZS ) {
+			_received_index = index;
+		}
+	} else if ( opcode == ARTNET_ART_SYNC ) {
+		opcode = ARTNET_NOP;
+		if (( packetSize >= 14 ) && ( _packet_buffer[11] >= 14 )) {
+			for (int n=0; n<_universe_count; n++) {
+				if ( _universes[n]->parse_art_sync(wUDP) == ARTNET_ART_DMX ) {
+					opcode = ARTNET_ART_DMX;
+					_sync_received = 1;
+				}
+			}
+		}
+	} else if (( opcode == ARTNET_ART_TOD_CONTROL ) || ( opcode == ARTNET_ART_RDM )) {
+		uint8_t index = indexForPortAddress(_packet_buffer[23], _packet_buffer[21]);
+		if ( index == ARTNET_NODE_NO_UNIVERSE ) {
+			return ARTNET_NOP;
+		}
+		opcode = _universes[index]->parse_opcode(wUDP, opcode, packetSize);
+	} else if ( opcode == ARTNET_ART_TOD_REQUEST ) {
+		uint16_t result = ARTNET_NOP;
+		for (int n=0; n<_universe_count; n++) {
+			if ( _universes[n]->parse_opcode(wUDP, opcode, packetSize) == ARTNET_ART_TOD_REQUEST ) {
+				result = ARTNET_ART_TOD_REQUEST;
+			}
+		}
+		opcode = result;
+	} else if ( opcode == ARTNET_ART_ADDRESS ) {
+		for (int n=0; n<_universe_count; n++) {
+			LXDMXMerge::clearChanges(&_universes[n]->_changes);	// only changes made by this ArtAddress are reported
+		}
+		opcode = _universes[0]->parse_opcode(wUDP, opcode, packetSize);
+		if (( opcode == ARTNET_ART_ADDRESS ) || ( opcode == ARTNET_ART_DMX )) {
+			updateUniverseTable();							// Port-Address may have been changed
+		}
+		if ( opcode == ARTNET_ART_DMX ) {					// ArtAddress cleared output
+			opcode = ARTNET_ART_ADDRESS;
+			for (int n=0; n<_universe_count; n++) {
+				if ( _universes[n]->changedSlotsFirst() ) {
+					opcode = ARTNET_ART_DMX;
+					if ( _received_index == ARTNET_NODE_NO_UNIVERSE ) {
+						_received_index = n;
+					} else {
+						_sync_received = 1;				// more than one, as with ArtSync
+					}
+				}
+			}
+			if ( _sync_received ) {
+				_received_index = ARTNET_NODE_NO_UNIVERSE;
+			}
+		}
+	} else if ( opcode != ARTNET_NOP ) {
+		opcode = _universes[0]->parse_opcode(wUDP, opcode, packetSize);
+	}
+	return opcode;
+}
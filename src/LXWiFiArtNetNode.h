@@ -0,0 +1,184 @@
+/* LXWiFiArtNetNode.h
+   Copyright 2026 by Claude Heintz Design
+   see LXDMXWiFi.h for LICENSE
+
+	Art-Net(TM) Designed by and Copyright Artistic Licence Holdings Ltd.
+*/
+
+#ifndef LXWIFIARTNETNODE_H
+#define LXWIFIARTNETNODE_H
+
+#include <Arduino.h>
+#include "LXDMXWiFi.h"
+#include "LXWiFiArtNet.h"
+
+#define ARTNET_NODE_MAX_UNIVERSES 16
+#define ARTNET_NODE_NO_UNIVERSE 0xff
+
+/*!
+*  @class LXWiFiArtNetNode
+*  @abstract
+*     LXWiFiArtNetNode receives Art-Net for several universes through a single packet buffer.
+*
+*  	Each universe is an LXWiFiArtNet instance created by addUniverse() and sharing the node's
+*     packet buffer.  The Art-Net header of an incoming packet is parsed once.  ArtDMX packets
+*     are then handed to the universe with the matching Port-Address found through a table
+*     indexed by the low byte (sub-net/universe) of the Port-Address.
+*
+*     ArtSync is passed to every universe.
+*     All other packets such as ArtPoll and ArtAddress are handled by the first universe.
+*/
+class LXWiFiArtNetNode {
+
+  public:
+/*!
+* @brief constructor with address used for ArtPollReply
+* @param address sent in ArtPollReply
+* @param subnet_mask used to set broadcast address
+*/
+	LXWiFiArtNetNode  ( IPAddress address, IPAddress subnet_mask );
+
+/*!
+* @brief destructor for LXWiFiArtNetNode (deletes universes and frees packet buffer)
+*/
+   ~LXWiFiArtNetNode ( void );
+
+/*!
+* @brief UDP port used by protocol
+*/
+   uint16_t dmxPort ( void ) { return ARTNET_PORT; }
+
+/*!
+* @brief create a universe sharing the node's packet buffer
+* @discussion The first universe added answers ArtPoll and ArtAddress for the node.
+*             Its ArtPollReply lists every universe as a port (see LXWiFiArtNet::addPort).
+* @param u complete 15 bit Port-Address net(7)-subnet(4)-universe(4)
+* @return pointer to LXWiFiArtNet for the universe or NULL if no more universes can be added
+*/
+   LXWiFiArtNet* addUniverse ( uint16_t u );
+
+/*!
+* @brief number of universes added to node
+*/
+   uint8_t numberOfUniverses ( void );
+
+/*!
+* @brief universe in order added
+* @param index 0 to numberOfUniverses()-1
+* @return pointer to LXWiFiArtNet for the universe or NULL
+*/
+   LXWiFiArtNet* universeAtIndex ( uint8_t index );
+
+/*!
+* @brief universe matching a Port-Address
+* @param u complete 15 bit Port-Address
+* @return pointer to LXWiFiArtNet for the universe or NULL
+*/
+   LXWiFiArtNet* universeForPortAddress ( uint16_t u );
+
+/*!
+* @brief universe that received the last ArtDMX or ArtNzs packet, or whose output was cleared by ArtAddress
+* @return pointer to LXWiFiArtNet or NULL if last packet was not dmx
+*/
+   LXWiFiArtNet* receivedUniverse ( void );
+
+/*!
+* @brief last packet was an ArtSync that updated the output of one or more universes
+*        (or an ArtAddress that cleared the output of more than one universe)
+* @discussion receivedUniverse() is NULL after ArtSync.  Use changedSlotsFirst() of each universe
+*             to find the universes that changed.
+*/
+   uint8_t syncReceived ( void );
+
+/*!
+* @brief rebuild the Port-Address lookup table
+* @discussion Call after changing the universe of an LXWiFiArtNet belonging to the node.
+*             The table is rebuilt automatically after an ArtAddress packet.
+*/
+   void updateUniverseTable ( void );
+
+ /*!
+ * @brief direct pointer to packet buffer uint8_t[]
+ * @return uint8_t* to packet buffer
+ */
+   uint8_t* packetBuffer      ( void );
+
+/*!
+ * @brief size of last packet received with readDMXPacket
+ * @return uint16_t last packet size
+ */
+   uint16_t packetSize      ( void );
+
+ /*!
+ * @brief read UDP packet
+ * @param wUDP pointer to UDP object
+ * @return RESULT_DMX_RECEIVED if packet contains dmx for one of the universes (see receivedUniverse())
+ */
+   uint8_t  readDMXPacket       ( UDP* wUDP );
+ /*!
+ * @brief read contents of packet from packetBuffer()
+ * @param wUDP pointer to UDP object
+ * @param packetSize size of received packet
+ * @return RESULT_DMX_RECEIVED if packet contains dmx for one of the universes (see receivedUniverse())
+ */
+   uint8_t readDMXPacketContents ( UDP* wUDP, uint16_t packetSize );
+ /*!
+ * @brief process packet, reading it into packetBuffer()
+ * @param wUDP pointer to UDP object
+ * @return Art-Net opcode of packet
+ */
+   uint16_t readArtNetPacket    ( UDP* wUDP );
+ /*!
+ * @brief read contents of packet from packetBuffer()
+ * @param wUDP pointer to UDP object (used for Poll Reply if applicable)
+ * @param packetSize size of received packet
+ * @return Art-Net opcode of packet
+ */
+   uint16_t readArtNetPacketContents ( UDP* wUDP, uint16_t packetSize );
+
+  private:
+/*!
+* @brief array that holds contents of incoming packet, shared by all universes
+*/
+  	uint8_t*   _packet_buffer;
+
+/*!
+* @brief size of last packet that was read with readDMXPacket
+*/
+	uint16_t  _packetSize;
+
+/*!
+* @brief universes in the order they were added
+*/
+	LXWiFiArtNet* _universes[ARTNET_NODE_MAX_UNIVERSES];
+
+/// number of universes added
+	uint8_t _universe_count;
+
+/// address passed to universes for ArtPollReply
+	IPAddress _my_address;
+/// subnet mask passed to universes for broadcast address
+	IPAddress _my_subnetmask;
+
+/// index of universe receiving last ArtDMX or ARTNET_NODE_NO_UNIVERSE
+	uint8_t _received_index;
+/// last packet was ArtSync that updated output
+	uint8_t _sync_received;
+
+/*!
+* @brief index of first universe for each low byte of Port-Address
+* @discussion universes with the same sub-net/universe but different net are chained
+*             through _universe_next.  Unused entries are ARTNET_NODE_NO_UNIVERSE.
+*/
+	uint8_t _universe_table[256];
+
+/// next universe with the same low byte of Port-Address
+	uint8_t _universe_next[ARTNET_NODE_MAX_UNIVERSES];
+
+/*!
+* @brief find index of universe from Port-Address bytes of ArtDMX
+*/
+	uint8_t indexForPortAddress ( uint8_t lo, uint8_t hi );
+};
+
+#endif // ifndef LXWIFIARTNETNODE_H
@@ -16,10 +16,24 @@
     v1.0 - First release
     v1.1 - adds ability to use external packet buffer
     v1.2 - adds respect of priority
+    v1.3 - word-at-a-time HTP merge
+    v1.4 - single source is copied directly to output without merge
+    v1.5 - adds changed slot reporting
+    v1.6 - adds sendDMXOnChange
+    v1.7 - separate transmit buffer built once with CID, source name and priority
+    v1.8 - discards late packets using sequence
+    v1.9 - adds universe discovery
+    v2.0 - per-address priority (0xDD start code) merge
+    v2.1 - releases terminated sources at once, ignores preview data
+    v2.2 - adds E1.31 synchronization
+    v2.3 - synchronization packets are checked for sender and sequence
+    v2.4 - default CID is a random UUID instead of zero
 */
 /**************************************************************************/
 
 #include "LXWiFiSACN.h"
+#include "LXDMXWiFiMerge.h"
+#include "LXWiFiSACNDiscovery.h"
 
 LXWiFiSACN::LXWiFiSACN ( void )
 {
@@ -36,6 +50,21 @@ LXWiFiSACN::~LXWiFiSACN ( void )
     if ( _owns_buffer ) {		// if we created this buffer, then free the memory
 		free(_packet_buffer);
 	}
+	if ( _tx_buffer ) {
+		free(_tx_buffer);
+	}
+	if ( _tx_last ) {
+		free(_tx_last);
+	}
+	if ( _address_priority ) {
+		free(_address_priority);
+	}
+	if ( _sync_buffer ) {
+		free(_sync_buffer);
+	}
+	if ( _owns_discovery ) {
+		delete _discovery;
+	}
 }
 
 void  LXWiFiSACN::initialize  ( uint8_t* b ) {
@@ -66,17 +95,45 @@ void  LXWiFiSACN::initialize  ( uint8_t* b ) {
     _dmx_slots = 0;
     _dmx_slots_a = 0;
     _dmx_slots_b = 0;
+    _changes.use_bitmap = 0;
+    memset(_changes.bitmap, 0, DMX_CHANGE_BITMAP_SIZE);
+    LXDMXMerge::clearChanges(&_changes);
     _priority_a = 0;
     _priority_b = 0;
+    memset(&_sequence_a, 0, sizeof(SACNSourceSequence));
+    memset(&_sequence_b, 0, sizeof(SACNSourceSequence));
+    _address_priority = NULL;
+    _priority_fill[SACN_SOURCE_A] = 0;
+    _priority_fill[SACN_SOURCE_B] = 0;
+    _sync_buffer = NULL;
+    _sync_holding = 0;
+    _sync_slots = 0;
+    _sync_address = 0;
+    _last_sync = millis() - SACN_SYNC_TIMEOUT - 1;
+    clear_sync_sequence(SACN_SOURCE_A);
+    clear_sync_sequence(SACN_SOURCE_B);
+    _sync_sequence = 0;
     _universe = 1;                    // NOTE: unlike Art-Net, sACN universes begin at 1
     _sequence = 1;
+    _tx_buffer = NULL;
+    _tx_changed = 1;
+    _tx_last = NULL;
+    _tx_repeats = 0;
+    _tx_slots = 0;
+    _last_send = 0;
+    _min_send_interval = DMX_MIN_SEND_INTERVAL;
+    _last_discovery = millis() - SACN_DISCOVERY_INTERVAL;	// send with first call
+    _discovery = NULL;
+    _owns_discovery = 0;
 }
 
 void LXWiFiSACN::clearDMXOutput ( void ) {
+	LXDMXMerge::clearChanges(&_changes);
+	LXDMXMerge::copySlots(&_dmx_buffer_c[1], NULL, 0, DMX_UNIVERSE_SIZE, &_changes);
+	_dmx_buffer_c[0] = 0;
 	for (int n=0; n<SLOTS_AND_START_CODE; n++) {
 	   _dmx_buffer_a[n] = 0;
 	   _dmx_buffer_b[n] = 0;
-	   _dmx_buffer_c[n] = 0;
 	   if ( n < SACN_CID_LENGTH ) {
 			_dmx_sender_id_a[n] = 0;
 			_dmx_sender_id_b[n] = 0;
@@ -89,6 +146,14 @@ void LXWiFiSACN::clearDMXOutput ( void ) {
     _priority_a = 0;
     _priority_b = 0;
     _last_packet_a = 0;
+    memset(&_sequence_a, 0, sizeof(SACNSourceSequence));
+    memset(&_sequence_b, 0, sizeof(SACNSourceSequence));
+    clear_address_priority(SACN_SOURCE_A);
+    clear_address_priority(SACN_SOURCE_B);
+    clear_sync_sequence(SACN_SOURCE_A);
+    clear_sync_sequence(SACN_SOURCE_B);
+    _sync_holding = 0;
+    _sync_slots = 0;
 }
 
 void LXWiFiSACN::clearDMXSourceB ( void ) {
@@ -100,6 +165,9 @@ void LXWiFiSACN::clearDMXSourceB ( void ) {
 	}
 	_priority_b = 0;
 	_dmx_slots_b = 0;
+	memset(&_sequence_b, 0, sizeof(SACNSourceSequence));
+	clear_address_priority(SACN_SOURCE_B);
+	clear_sync_sequence(SACN_SOURCE_B);
 }
 
 uint16_t  LXWiFiSACN::universe ( void ) {
@@ -122,11 +190,21 @@ void LXWiFiSACN::setNumberOfSlots ( int n ) {
 }
 
 uint8_t LXWiFiSACN::getSlot ( int slot ) {
+	if ( _sync_holding ) {
+		return _sync_buffer[slot];
+	}
 	return _dmx_buffer_c[slot];
 }
 
 void LXWiFiSACN::setSlot ( int slot, uint8_t level ) {
-	_packet_buffer[SACN_ADDRESS_OFFSET+slot] = level;
+	uint8_t* tx = tx_buffer();
+	if ( tx == NULL ) {
+		return;
+	}
+	if ( tx[SACN_ADDRESS_OFFSET+slot] != level ) {
+		tx[SACN_ADDRESS_OFFSET+slot] = level;
+		_tx_changed = 1;
+	}
 }
 
 uint8_t LXWiFiSACN::startCode ( void ) {
@@ -134,11 +212,108 @@ uint8_t LXWiFiSACN::startCode ( void ) {
 }
 
 void LXWiFiSACN::setStartCode ( uint8_t value ) {
-	_packet_buffer[SACN_ADDRESS_OFFSET] = value;
+	uint8_t* tx = tx_buffer();
+	if ( tx == NULL ) {
+		return;
+	}
+	if ( tx[SACN_ADDRESS_OFFSET] != value ) {
+		tx[SACN_ADDRESS_OFFSET] = value;
+		_tx_changed = 1;
+	}
+}
+
+uint16_t LXWiFiSACN::changedSlotsFirst ( void ) {
+	if ( _changes.first == DMX_NO_CHANGE ) {
+		return 0;
+	}
+	return _changes.first + 1;
+}
+
+uint16_t LXWiFiSACN::changedSlotsLast ( void ) {
+	if ( _changes.first == DMX_NO_CHANGE ) {
+		return 0;
+	}
+	return _changes.last + 1;
+}
+
+uint8_t LXWiFiSACN::slotChanged ( int slot ) {
+	uint16_t index = slot - 1;
+	if (( _changes.first == DMX_NO_CHANGE ) || ( index < _changes.first ) || ( index > _changes.last )) {
+		return 0;
+	}
+	if ( _changes.use_bitmap ) {
+		return ( _changes.bitmap[index >> 3] >> (index & 7) ) & 1;
+	}
+	return 1;
+}
+
+void LXWiFiSACN::setChangedSlotBitmap ( uint8_t en ) {
+	memset(_changes.bitmap, 0, DMX_CHANGE_BITMAP_SIZE);
+	_changes.use_bitmap = en;
+	if ( en && ( _changes.first != DMX_NO_CHANGE ) ) {	// bits were not kept for current range
+		LXDMXMerge::addChanges(&_changes, _changes.first, _changes.last);
+	}
+}
+
+uint8_t* LXWiFiSACN::changedSlotBitmap ( void ) {
+	return &_changes.bitmap[0];
+}
+
+uint32_t LXWiFiSACN::sequenceGapCount ( uint8_t source ) {
+	return ( source == SACN_SOURCE_B ) ? _sequence_b.gaps : _sequence_a.gaps;
+}
+
+uint32_t LXWiFiSACN::sequenceReorderCount ( uint8_t source ) {
+	return ( source == SACN_SOURCE_B ) ? _sequence_b.reorders : _sequence_a.reorders;
+}
+
+void LXWiFiSACN::resetSequenceCounts ( void ) {
+	_sequence_a.gaps = 0;
+	_sequence_a.reorders = 0;
+	_sequence_b.gaps = 0;
+	_sequence_b.reorders = 0;
 }
 
 uint8_t* LXWiFiSACN::dmxData( void ) {
-	return &_packet_buffer[SACN_ADDRESS_OFFSET];
+	uint8_t* tx = tx_buffer();
+	if ( tx == NULL ) {
+		return NULL;
+	}
+	if ( _tx_last == NULL ) {		// caller may write directly, keep what was sent to compare
+		_tx_last = (uint8_t*) malloc(DMX_UNIVERSE_SIZE+1);
+		if ( _tx_last == NULL ) {
+			_tx_changed = 1;		// without the copy, treat as changed
+		} else {
+			memcpy(_tx_last, &tx[SACN_ADDRESS_OFFSET], DMX_UNIVERSE_SIZE+1);
+		}
+	}
+	return &tx[SACN_ADDRESS_OFFSET];
+}
+
+void LXWiFiSACN::setCID ( uint8_t* cid ) {
+	uint8_t* tx = tx_buffer();
+	if ( tx ) {
+		memcpy(&tx[22], cid, SACN_CID_LENGTH);
+	}
+}
+
+void LXWiFiSACN::setSourceName ( const char* name ) {
+	uint8_t* tx = tx_buffer();
+	if ( tx == NULL ) {
+		return;
+	}
+	memset(&tx[SACN_SOURCE_NAME_OFFSET], 0, SACN_SOURCE_NAME_LENGTH);
+	strncpy((char*)&tx[SACN_SOURCE_NAME_OFFSET], name, SACN_SOURCE_NAME_LENGTH-1);
+}
+
+void LXWiFiSACN::setPriority ( uint8_t priority ) {
+	if ( priority > 200 ) {
+		priority = 200;
+	}
+	uint8_t* tx = tx_buffer();
+	if ( tx ) {
+		tx[SACN_PRIORITY_OFFSET] = priority;
+	}
 }
 
 uint8_t* LXWiFiSACN::packetBuffer( void ) {
@@ -153,7 +328,7 @@ uint8_t LXWiFiSACN::readDMXPacket ( UDP* wUDP ) {
 	_packetSize = 0;
 	uint16_t t_slots = readSACNPacket(wUDP);
    if ( t_slots > 0 ) {
-   	if ( startCode() == 0 ) {
+   	if (( startCode() == 0 ) || ( _packet_buffer[21] == 0x08 )) {	// levels or synchronization
    		_dmx_slots = t_slots;
    		return RESULT_DMX_RECEIVED;
    	}
@@ -164,7 +339,7 @@ uint8_t LXWiFiSACN::readDMXPacket ( UDP* wUDP ) {
 uint8_t LXWiFiSACN::readDMXPacketContents ( UDP* wUDP, uint16_t packetSize ) {
 	uint16_t t_slots = parse_root_layer(packetSize);
 	if ( t_slots > 0 ) {
-   	if ( startCode() == 0 ) {
+   	if (( startCode() == 0 ) || ( _packet_buffer[21] == 0x08 )) {	// levels or synchronization
    		_dmx_slots = t_slots;
    		return RESULT_DMX_RECEIVED;
    	}
@@ -182,55 +357,211 @@ uint16_t LXWiFiSACN::readSACNPacket ( UDP* wUDP ) {
    return t_slots;
 }
 
+/*
+  only sequence, universe and the lengths change between frames
+*/
 void LXWiFiSACN::sendDMX ( UDP* wUDP, IPAddress to_ip, IPAddress interfaceAddr ) {
-   for (int n=0; n<126; n++) {
-    	_packet_buffer[n] = 0;		// zero outside layers & start code
-    }
-   _packet_buffer[0] = 0;
-   _packet_buffer[1] = 0x10;
-   _packet_buffer[4] = 'A';
-   _packet_buffer[5] = 'S';
-   _packet_buffer[6] = 'C';
-   _packet_buffer[7] = '-';
-   _packet_buffer[8] = 'E';
-   _packet_buffer[9] = '1';
-   _packet_buffer[10] = '.';
-   _packet_buffer[11] = '1';
-   _packet_buffer[12] = '7';
+   uint8_t* tx = tx_buffer();
+   if ( tx == NULL ) {
+      return;
+   }
    uint16_t fplusl = _dmx_slots + 110 + 0x7000;
-   _packet_buffer[16] = fplusl >> 8;
-   _packet_buffer[17] = fplusl & 0xff;
-   _packet_buffer[21] = 0x04;
+   tx[16] = fplusl >> 8;
+   tx[17] = fplusl & 0xff;
    fplusl = _dmx_slots + 88 + 0x7000;
-   _packet_buffer[38] = fplusl >> 8;
-   _packet_buffer[39] = fplusl & 0xff;
-   _packet_buffer[43] = 0x02;
-   _packet_buffer[44] = 'A';
-   _packet_buffer[45] = 'r';
-   _packet_buffer[46] = 'd';
-   _packet_buffer[47] = 'u';
-   _packet_buffer[48] = 'i';
-   _packet_buffer[49] = 'n';
-   _packet_buffer[50] = 'o';
-   _packet_buffer[108] = 100;	//priority
+   tx[38] = fplusl >> 8;
+   tx[39] = fplusl & 0xff;
    if ( _sequence == 0 ) {
      _sequence = 1;
    } else {
      _sequence++;
    }
-   _packet_buffer[111] = _sequence;
-   _packet_buffer[113] = _universe >> 8;
-   _packet_buffer[114] = _universe & 0xff;
+   tx[111] = _sequence;
+   tx[113] = _universe >> 8;
+   tx[114] = _universe & 0xff;
    fplusl = _dmx_slots + 11 + 0x7000;
-   _packet_buffer[115] = fplusl >> 8;
-   _packet_buffer[116] = fplusl & 0xff;
-   _packet_buffer[117] = 0x02;
-   _packet_buffer[118] = 0xa1;
-   _packet_buffer[122] = 0x01;
+   tx[115] = fplusl >> 8;
+   tx[116] = fplusl & 0xff;
    fplusl = _dmx_slots + 1;
-   _packet_buffer[123] = fplusl >> 8;
-   _packet_buffer[124] = fplusl & 0xFF;
+   tx[123] = fplusl >> 8;
+   tx[124] = fplusl & 0xFF;
    //assume dmx data has been set
+   begin_packet(wUDP, to_ip, interfaceAddr);
+   wUDP->write(tx, _dmx_slots + 126);
+   wUDP->endPacket();
+   if ( tx_changed() ) {
+      _tx_repeats = SACN_CHANGE_REPEATS;
+   } else if ( _tx_repeats ) {
+      _tx_repeats--;
+   }
+   if ( _tx_last ) {
+      memcpy(_tx_last, &tx[SACN_ADDRESS_OFFSET], _dmx_slots+1);
+   }
+   _tx_changed = 0;
+   _tx_slots = _dmx_slots;
+   _last_send = millis();
+}
+
+/*
+  a change and its repeats wait only for the minimum interval, otherwise keepalive
+*/
+uint8_t LXWiFiSACN::sendDMXOnChange ( UDP* wUDP, IPAddress to_ip, IPAddress interfaceAddr ) {
+   if ( tx_buffer() == NULL ) {
+      return 0;
+   }
+   unsigned long elapsed = millis() - _last_send;
+   if ( _tx_repeats || tx_changed() ) {
+      if ( elapsed < _min_send_interval ) {
+         return 0;
+      }
+   } else if ( elapsed < SACN_KEEPALIVE_INTERVAL ) {
+      return 0;
+   }
+   sendDMX(wUDP, to_ip, interfaceAddr);
+   return 1;
+}
+
+/*
+  levels written through dmxData() are found by comparing with the copy of the last frame sent
+*/
+uint8_t LXWiFiSACN::tx_changed( void ) {
+   if ( _tx_changed || ( _tx_slots != _dmx_slots ) ) {
+      return 1;
+   }
+   if ( _tx_last ) {
+      return ( memcmp(_tx_last, &_tx_buffer[SACN_ADDRESS_OFFSET], _dmx_slots+1) != 0 );
+   }
+   return 0;
+}
+
+void LXWiFiSACN::setMinimumSendInterval ( uint16_t ms ) {
+   _min_send_interval = ms;
+}
+
+void LXWiFiSACN::setSyncAddress ( uint16_t u ) {
+   uint8_t* tx = tx_buffer();
+   if ( tx == NULL ) {
+      return;
+   }
+   tx[SACN_SYNC_ADDRESS_OFFSET] = u >> 8;
+   tx[SACN_SYNC_ADDRESS_OFFSET+1] = u & 0xff;
+}
+
+/*
+  root vector VECTOR_ROOT_E131_EXTENDED, framing vector VECTOR_E131_EXTENDED_SYNCHRONIZATION
+  synchronization packets have their own sequence
+*/
+void LXWiFiSACN::sendSync ( UDP* wUDP, IPAddress to_ip, IPAddress interfaceAddr ) {
+   uint8_t* tx = tx_buffer();
+   if ( tx == NULL ) {
+      return;
+   }
+   uint8_t sync[SACN_SYNC_SIZE];
+   memset(sync, 0, SACN_SYNC_SIZE);
+   sync[1] = 0x10;                            // preamble size
+   strcpy((char*)&sync[4], "ASC-E1.17");
+   uint16_t fplusl = SACN_SYNC_SIZE - 16 + 0x7000;
+   sync[16] = fplusl >> 8;
+   sync[17] = fplusl & 0xff;
+   sync[21] = 0x08;                           // root vector E1.31 extended
+   memcpy(&sync[22], &tx[22], SACN_CID_LENGTH);
+   fplusl = SACN_SYNC_SIZE - 38 + 0x7000;
+   sync[38] = fplusl >> 8;
+   sync[39] = fplusl & 0xff;
+   sync[43] = 0x01;                           // framing vector extended synchronization
+   sync[44] = ++_sync_sequence;
+   sync[45] = tx[SACN_SYNC_ADDRESS_OFFSET];
+   sync[46] = tx[SACN_SYNC_ADDRESS_OFFSET+1];
+
+   begin_packet(wUDP, to_ip, interfaceAddr);
+   wUDP->write(sync, SACN_SYNC_SIZE);
+   wUDP->endPacket();
+}
+
+/*
+  header is built on the stack for each page, universes are written in small chunks
+  so that the list does not have to be copied into a packet buffer
+*/
+void LXWiFiSACN::sendUniverseDiscovery ( UDP* wUDP, IPAddress interfaceAddr, uint16_t* universes, uint16_t count ) {
+   uint8_t* tx = tx_buffer();
+   if ( tx == NULL ) {
+      return;
+   }
+   uint8_t header[SACN_DISCOVERY_HEADER_SIZE];
+   memset(header, 0, SACN_DISCOVERY_HEADER_SIZE);
+   header[1] = 0x10;                          // preamble size
+   strcpy((char*)&header[4], "ASC-E1.17");
+   header[21] = 0x08;                         // root vector E1.31 extended
+   memcpy(&header[22], &tx[22], SACN_CID_LENGTH);
+   header[43] = 0x02;                         // framing vector extended discovery
+   memcpy(&header[SACN_SOURCE_NAME_OFFSET], &tx[SACN_SOURCE_NAME_OFFSET], SACN_SOURCE_NAME_LENGTH);
+   header[117] = 0x01;                        // discovery vector universe list
+   uint8_t last_page = ( count == 0 ) ? 0 : (count - 1) / SACN_DISCOVERY_PAGE_SIZE;
+   header[119] = last_page;
+
+   uint8_t page = 0;
+   do {
+      uint16_t page_count = count - page * SACN_DISCOVERY_PAGE_SIZE;
+      if ( page_count > SACN_DISCOVERY_PAGE_SIZE ) {
+         page_count = SACN_DISCOVERY_PAGE_SIZE;
+      }
+      uint16_t size = SACN_DISCOVERY_HEADER_SIZE + 2 * page_count;
+      uint16_t fplusl = size - 16 + 0x7000;
+      header[16] = fplusl >> 8;
+      header[17] = fplusl & 0xff;
+      fplusl = size - 38 + 0x7000;
+      header[38] = fplusl >> 8;
+      header[39] = fplusl & 0xff;
+      fplusl = size - 112 + 0x7000;
+      header[112] = fplusl >> 8;
+      header[113] = fplusl & 0xff;
+      header[118] = page;
+
+      begin_packet(wUDP, IPAddress(239,255,250,214), interfaceAddr);
+      wUDP->write(header, SACN_DISCOVERY_HEADER_SIZE);
+      uint16_t* list = &universes[page * SACN_DISCOVERY_PAGE_SIZE];
+      uint8_t chunk[64];
+      uint16_t n = 0;
+      while ( n < page_count ) {
+         uint8_t c = 0;
+         while (( c < 64 ) && ( n < page_count )) {
+            chunk[c++] = list[n] >> 8;
+            chunk[c++] = list[n] & 0xff;
+            n++;
+         }
+         wUDP->write(chunk, c);
+      }
+      wUDP->endPacket();
+      page++;
+   } while ( page <= last_page );
+}
+
+uint8_t LXWiFiSACN::sendUniverseDiscoveryOnInterval ( UDP* wUDP, IPAddress interfaceAddr ) {
+   if ( millis() - _last_discovery < SACN_DISCOVERY_INTERVAL ) {
+      return 0;
+   }
+   sendUniverseDiscovery(wUDP, interfaceAddr, &_universe, 1);
+   _last_discovery = millis();
+   return 1;
+}
+
+LXWiFiSACNDiscovery* LXWiFiSACN::discovery ( void ) {
+   if ( _discovery == NULL ) {
+      _discovery = new LXWiFiSACNDiscovery();
+      _owns_discovery = 1;
+   }
+   return _discovery;
+}
+
+void LXWiFiSACN::setDiscovery ( LXWiFiSACNDiscovery* d ) {
+   if ( _owns_discovery ) {
+      delete _discovery;
+   }
+   _discovery = d;
+   _owns_discovery = 0;
+}
+
+void LXWiFiSACN::begin_packet( UDP* wUDP, IPAddress to_ip, IPAddress interfaceAddr ) {
    if ( interfaceAddr != INADDR_ANY ) {
    
 // Multicast is supported by WiFiUDP in ESP8266WiFi, but not in WiFi101 WiFiUDP
@@ -243,13 +574,48 @@ void LXWiFiSACN::sendDMX ( UDP* wUDP, IPAddress to_ip, IPAddress interfaceAddr )
    } else {
       wUDP->beginPacket(to_ip, SACN_PORT);
    }
-   wUDP->write(_packet_buffer, _dmx_slots + 126);
-   wUDP->endPacket();
+}
+
+uint8_t* LXWiFiSACN::tx_buffer( void ) {
+   if ( _tx_buffer == NULL ) {
+      _tx_buffer = (uint8_t*) malloc(SACN_BUFFER_MAX);
+      if ( _tx_buffer == NULL ) {
+         return NULL;
+      }
+      memset(_tx_buffer, 0, SACN_BUFFER_MAX);
+      _tx_buffer[1] = 0x10;                      // preamble size
+      strcpy((char*)&_tx_buffer[4], "ASC-E1.17");
+      _tx_buffer[21] = 0x04;                     // root vector E1.31 data
+      for (int k=0; k<SACN_CID_LENGTH; k++) {    // random (version 4) UUID until setCID
+         _tx_buffer[22+k] = random(256);
+      }
+      if ( _tx_buffer[22] == 0 ) {
+         _tx_buffer[22] = 1;                     // a first byte of zero is read as no sender
+      }
+      _tx_buffer[28] = ( _tx_buffer[28] & 0x0f ) | 0x40;   // version 4
+      _tx_buffer[30] = ( _tx_buffer[30] & 0x3f ) | 0x80;   // variant 1
+      _tx_buffer[43] = 0x02;                     // framing vector DMP
+      strcpy((char*)&_tx_buffer[SACN_SOURCE_NAME_OFFSET], "Arduino");
+      _tx_buffer[SACN_PRIORITY_OFFSET] = SACN_DEFAULT_PRIORITY;
+      _tx_buffer[117] = 0x02;                    // DMP set property
+      _tx_buffer[118] = 0xa1;                    // address and data format
+      _tx_buffer[122] = 0x01;                    // address increment
+   }
+   return _tx_buffer;
 }
 
 uint16_t LXWiFiSACN::parse_root_layer( uint16_t size ) {
   if  ( _packet_buffer[1] == 0x10 ) {									//preamble size
     if ( strcmp((const char*)&_packet_buffer[4], "ASC-E1.17") == 0 ) {
+      if ( _packet_buffer[21] == 0x08 ) {							// vector RLP is 1.31 extended
+        if ( _packet_buffer[43] == 0x01 ) {							// synchronization
+          return parse_sync_packet( size );
+        }
+        if ( _discovery ) {
+          _discovery->readDiscoveryPacket(_packet_buffer, size);	// (checks its own lengths)
+        }
+        return 0;
+      }
       uint16_t tsize = size - 16;
       if ( checkFlagsAndLength(&_packet_buffer[16], tsize) ) { // root pdu length
         if ( _packet_buffer[21] == 0x04 ) {							// vector RLP is 1.31 data
@@ -261,125 +627,230 @@ uint16_t LXWiFiSACN::parse_root_layer( uint16_t size ) {
   return 0;
 }
 
+uint8_t compareCID(uint8_t* cid_a, uint8_t* cid_b) {
+	for(int k=0; k<SACN_CID_LENGTH; k++) {
+	   if ( cid_a[k] != cid_b[k] ) {
+         return 0;
+      }
+	}
+	return 1;
+}
+
 uint16_t LXWiFiSACN::parse_framing_layer( uint16_t size ) {
    uint16_t tsize = size - 22;
    if ( checkFlagsAndLength(&_packet_buffer[38], tsize) ) {     // framing pdu length
      if ( _packet_buffer[43] == 0x02 ) {                        // vector dmp is 1.31
         if ( (_packet_buffer[114] | ( _packet_buffer[113] << 8 )) == _universe ) {
-          return parse_dmp_layer( tsize );    
+          uint16_t sync_address = (_packet_buffer[SACN_SYNC_ADDRESS_OFFSET] << 8) | _packet_buffer[SACN_SYNC_ADDRESS_OFFSET+1];
+          if ( hold_for_sync(sync_address) ) {
+             // holding starts only once a packet is accepted for merge
+             uint16_t slots = parse_dmp_layer( tsize );
+             if ( slots ) {
+                _sync_holding = 1;
+                _sync_slots = slots;
+             }
+             return 0;
+          }
+          uint16_t slots = parse_dmp_layer( tsize );
+          if ( slots ) {
+             if ( sync_address != _sync_address ) {		// sync packets for the old address do not count
+                _sync_address = sync_address;
+                _last_sync = millis() - SACN_SYNC_TIMEOUT - 1;
+             }
+             if ( _sync_holding ) {
+                // unsynchronized levels or synchronization lost, stop holding
+                publish_sync();
+                _sync_holding = 0;
+                _sync_slots = 0;
+             }
+          }
+          return slots;
         }
      }
    }
    return 0;
 }
 
-uint8_t compareCID(uint8_t* cid_a, uint8_t* cid_b) {
-	for(int k=0; k<SACN_CID_LENGTH; k++) {
-	   if ( cid_a[k] != cid_b[k] ) {
+/*
+  E1.31 6.2.4.1: until a synchronization packet for its synchronization universe is received,
+  a packet is output at once.  If sync packets stop for SACN_SYNC_TIMEOUT, packets are
+  output at once again unless the sender sets Force_Synchronization.
+  _sync_address is only taken from packets that are used, so a sender that is not merged
+  does not change it.  Only level packets are held (0xDD packets never reach the output).
+  The output is saved before the packet is merged, the caller starts holding if it is accepted.
+  Without memory for the saved output, packets are output at once.
+*/
+uint8_t LXWiFiSACN::hold_for_sync( uint16_t sync_address ) {
+   if (( sync_address == 0 ) || ( sync_address != _sync_address ) || ( _packet_buffer[SACN_ADDRESS_OFFSET] != 0 )) {
+      return 0;
+   }
+   if ( millis() - _last_sync > SACN_SYNC_TIMEOUT ) {
+      if ( ! ( _sync_holding && ( _packet_buffer[SACN_OPTIONS_OFFSET] & SACN_OPTION_FORCE_SYNC ) ) ) {
          return 0;
       }
+   }
+   if ( ! _sync_holding ) {
+      if ( _sync_buffer == NULL ) {
+         _sync_buffer = (uint8_t*) malloc(SLOTS_AND_START_CODE);
+         if ( _sync_buffer == NULL ) {
+            return 0;
+         }
+      }
+      memcpy(_sync_buffer, _dmx_buffer_c, SLOTS_AND_START_CODE);
+      _sync_slots = 0;
+   }
+   return 1;
+}
+
+void LXWiFiSACN::clear_sync_sequence( uint8_t source ) {
+   memset(&_sync_sequence_in[source], 0, sizeof(SACNSourceSequence));
+   _last_sync_in[source] = millis() - SACN_SYNC_TIMEOUT - 1;
+}
+
+/*
+  the levels held since the last sync are published at once, reported like a received packet
+  only sender a or b can synchronize the output.  E1.31 6.3.3: each sender's sync packets
+  have their own sequence, late ones are discarded like data packets
+*/
+uint16_t LXWiFiSACN::parse_sync_packet( uint16_t size ) {
+   if (( size < SACN_SYNC_SIZE ) || ! checkFlagsAndLength(&_packet_buffer[16], size - 16) ) {
+      return 0;
+   }
+   if ( ! checkFlagsAndLength(&_packet_buffer[38], size - 38) ) {
+      return 0;
+   }
+   uint16_t sync_address = (_packet_buffer[45] << 8) | _packet_buffer[46];
+   if (( sync_address == 0 ) || ( sync_address != _sync_address )) {
+      return 0;
+   }
+   uint8_t source;
+   if ( _dmx_sender_id_a[0] && compareCID(&_dmx_sender_id_a[0], &_packet_buffer[22]) ) {
+      source = SACN_SOURCE_A;
+   } else if ( _dmx_sender_id_b[0] && compareCID(&_dmx_sender_id_b[0], &_packet_buffer[22]) ) {
+      source = SACN_SOURCE_B;
+   } else {
+      return 0;
+   }
+   uint8_t sequence = _packet_buffer[SACN_SYNC_SEQUENCE_OFFSET];
+   if ( millis() - _last_sync_in[source] <= SACN_SYNC_TIMEOUT ) {
+      if ( ! check_sequence(&_sync_sequence_in[source], sequence) ) {
+         return 0;
+      }
+   } else {
+      start_sequence(&_sync_sequence_in[source], sequence);
+   }
+   _last_sync_in[source] = millis();
+   _last_sync = millis();
+   if (( _sync_holding == 0 ) || ( _sync_slots == 0 )) {
+      return 0;
+   }
+   publish_sync();
+   uint16_t slots = _sync_slots;
+   _sync_slots = 0;
+   return slots;
+}
+
+void LXWiFiSACN::publish_sync( void ) {
+   LXDMXMerge::clearChanges(&_changes);
+   _sync_buffer[0] = _dmx_buffer_c[0];
+   LXDMXMerge::copySlots(&_sync_buffer[1], &_dmx_buffer_c[1], DMX_UNIVERSE_SIZE, DMX_UNIVERSE_SIZE, &_changes);
+}
+
+/*
+  E1.31 6.7.2: a packet that is up to SACN_SEQUENCE_WINDOW behind the last one (or a repeat of it)
+  is late and is discarded.  Anything further behind is accepted as a restarted sender.
+*/
+uint8_t LXWiFiSACN::check_sequence( SACNSourceSequence* source, uint8_t sequence ) {
+	int8_t diff = (int8_t)(sequence - source->sequence);
+	if (( diff <= 0 ) && ( diff > -SACN_SEQUENCE_WINDOW )) {
+		source->reorders++;
+		return 0;
 	}
+	if ( diff > 1 ) {
+		source->gaps += diff - 1;
+	}
+	source->sequence = sequence;
 	return 1;
 }
 
+void LXWiFiSACN::start_sequence( SACNSourceSequence* source, uint8_t sequence ) {
+	source->sequence = sequence;
+	source->gaps = 0;
+	source->reorders = 0;
+}
+
 uint16_t LXWiFiSACN::parse_dmp_layer( uint16_t size ) {
   uint16_t tsize = size - 77;
   if ( checkFlagsAndLength(&_packet_buffer[115], tsize) ) {  // dmp pdu length
     if ( _packet_buffer[117] == 0x02 ) {                     // Set Property
       if ( _packet_buffer[118] == 0xa1 ) {                   // address and data format
         uint16_t dsize = _packet_buffer[124] + (_packet_buffer[123] << 8);
-        if ( dsize != (tsize - 10) ) {
+        if (( dsize != (tsize - 10) ) || ( dsize == 0 )) {
            return 0;
         }
-    
-        // new October 2017 replace sender a if this packet has higher priority
-        // sender b only maintained for HTP when priority is equal
         
-        uint8_t new_higher_priority = 0;
-        uint8_t erase_b = 0;
-        
-        if ( _packet_buffer[SACN_PRIORITY_OFFSET] > _priority_a ) {
-        	// packet has higher priority than a or b (b only exists if equal to a)
-        	new_higher_priority = 1;
-        	erase_b = 1;
-        	
-        } else { // has lower or equal priority to sender a priority
-        
-        	if ( _priority_a > _packet_buffer[SACN_PRIORITY_OFFSET] ) {
-				// lower priority packet, no need for b if this came from b
-				if ( compareCID(&_dmx_sender_id_b[0], &_packet_buffer[22]) ) {
-					erase_b = 1;
-				}
-			}
-        	
-        	// but if haven't heard from source a for three seconds...
-        	if ( abs((long)(millis()-_last_packet_a)) > 3000 ) {
-        		// no more source a
-        		if ( _packet_buffer[SACN_PRIORITY_OFFSET] > _priority_b ) {
-        			// this packet takes over as source a if it has a higher priority than b
-        			//      (priority_b is zero if it does not exist)
-        			//      (could even be that this is a tardy packet from a)
-        			new_higher_priority = 1;
-        			erase_b = 1;
-				} else {
-					// otherwise copy b => a, handle this packet below as if it is a new b
-				   for(int k=0; k<SACN_CID_LENGTH; k++) {
-						_dmx_sender_id_a[k] = _dmx_sender_id_b[k];
-						_dmx_sender_id_b[k] = 0;
-					}
-					for(int k=0; k<SLOTS_AND_START_CODE; k++) {
-						_dmx_buffer_a[k] = _dmx_buffer_b[k];
-						_dmx_buffer_b[k] = 0;
-					}
-					_priority_a = _priority_b;
-					_priority_b = 0;
-        			_dmx_slots_a = _dmx_slots_b;
-        			_dmx_slots_b = 0;
-        			erase_b = 0;
-				}
-        	}
+        // late packets from a known sender are discarded before anything is copied
+        // a sender that has timed out may have restarted its sequence
+        if ( _dmx_sender_id_a[0] && compareCID(&_dmx_sender_id_a[0], &_packet_buffer[22]) ) {
+           if (( millis() - _last_packet_a <= SACN_SOURCE_TIMEOUT ) && ! check_sequence(&_sequence_a, _packet_buffer[SACN_SEQUENCE_OFFSET]) ) {
+              return 0;
+           }
+        } else if ( _dmx_sender_id_b[0] && compareCID(&_dmx_sender_id_b[0], &_packet_buffer[22]) ) {
+           if (( millis() - _last_packet_b <= SACN_SOURCE_TIMEOUT ) && ! check_sequence(&_sequence_b, _packet_buffer[SACN_SEQUENCE_OFFSET]) ) {
+              return 0;
+           }
         }
         
-        if ( erase_b ) {	// b exists and is flagged to be erased
-        	if ( _dmx_slots_b ) {
-        		clearDMXSourceB();
-        	}
+        // preview data is for visualizers, not output
+        if ( _packet_buffer[SACN_OPTIONS_OFFSET] & SACN_OPTION_PREVIEW ) {
+           return 0;
+        }
+        if ( _packet_buffer[SACN_OPTIONS_OFFSET] & SACN_OPTION_TERMINATED ) {
+           return terminate_source();
         }
         
-        if (( _dmx_sender_id_a[0] == 0  ) || new_higher_priority) {			
-          for(int k=0; k<SACN_CID_LENGTH; k++) {		 // if _dmx_sender_id is not set
-            _dmx_sender_id_a[k] = _packet_buffer[k+22];  // set it to id of this packet
-          }
+        // per-address priority is kept for the next merge, it is not DMX data
+        if ( _packet_buffer[SACN_ADDRESS_OFFSET] == SACN_PRIORITY_START_CODE ) {
+           read_address_priority(dsize-1);
+           return 0;
         }
+        LXDMXMerge::clearChanges(&_changes);
+    
+        // sender a is replaced by a higher priority sender, sender b is kept for HTP
+        // when its priority is equal or for a per slot merge when 0xDD is in use
+        uint8_t source = select_source(0);
         
-        if ( compareCID(&_dmx_sender_id_a[0], &_packet_buffer[22]) ) {
+        if ( source == SACN_SOURCE_A ) {
            _dmx_slots_a = dsize;
            _last_packet_a = millis();
            _priority_a = _packet_buffer[SACN_PRIORITY_OFFSET];
            
-           // if b exists and is expired, erase it
-           if ( _dmx_slots_b ) {
-			   if ( abs((long)(millis()-_last_packet_b)) > 3000 ) {
-				  clearDMXSourceB();
-			   }
-		   }
-           
-          int di;
-          if ( _priority_a == _priority_b ) {
-			  for (di=0; di<_dmx_slots_a; di++) {
-				 _dmx_buffer_a[di] = _packet_buffer[SACN_ADDRESS_OFFSET+di];
-				 if ( _dmx_buffer_a[di] > _dmx_buffer_b[di] ) {
-					_dmx_buffer_c[di] = _dmx_buffer_a[di];
-				 } else {
-					_dmx_buffer_c[di] = _dmx_buffer_b[di];
-				 }
-			  }
+          // start code is handled separately so that changes are recorded by slot
+          if ( address_priority_merge() ) {
+			  // per slot: highest priority, then HTP
+			  // until b sends levels, a is merged with its own priorities against b's empty buffer
+			  uint8_t* priority_b = _dmx_slots_b ? &_address_priority[DMX_UNIVERSE_SIZE] : _address_priority;
+			  _dmx_buffer_a[0] = _packet_buffer[SACN_ADDRESS_OFFSET];
+			  _dmx_buffer_c[0] = ( _dmx_buffer_a[0] > _dmx_buffer_b[0] ) ? _dmx_buffer_a[0] : _dmx_buffer_b[0];
+			  LXDMXMerge::mergePriorityHTP(&_dmx_buffer_a[1], &_packet_buffer[SACN_ADDRESS_OFFSET+1], dsize-1,
+			                               _address_priority, &_dmx_buffer_b[1], priority_b,
+			                               &_dmx_buffer_c[1], merge_slots(dsize-1), &_changes);
+		   } else if ( _dmx_slots_b == 0 ) {
+			  // single source: nothing to merge, _dmx_buffer_c holds the levels of sender a
+			  _dmx_buffer_c[0] = _packet_buffer[SACN_ADDRESS_OFFSET];
+			  LXDMXMerge::copySlots(&_dmx_buffer_c[1], &_packet_buffer[SACN_ADDRESS_OFFSET+1], dsize-1,
+			                        merge_slots(dsize-1), &_changes);
+		   } else if ( _priority_a == _priority_b ) {
+			  _dmx_buffer_a[0] = _packet_buffer[SACN_ADDRESS_OFFSET];
+			  _dmx_buffer_c[0] = ( _dmx_buffer_a[0] > _dmx_buffer_b[0] ) ? _dmx_buffer_a[0] : _dmx_buffer_b[0];
+			  LXDMXMerge::mergeHTP(&_dmx_buffer_a[1], &_packet_buffer[SACN_ADDRESS_OFFSET+1], dsize-1,
+			                       &_dmx_buffer_b[1], &_dmx_buffer_c[1], merge_slots(dsize-1), &_changes);
 		   } else {
-		      for (di=0; di<_dmx_slots_a; di++) {
-				 _dmx_buffer_a[di] = _packet_buffer[SACN_ADDRESS_OFFSET+di];
-				 // this packet has priority, sender_a will always have equal or higher priority
-				 _dmx_buffer_c[di] = _dmx_buffer_a[di];
-			  }
+			  // this packet has priority, b is released or takes the place of a with its next packet
+			  memcpy(_dmx_buffer_a, &_packet_buffer[SACN_ADDRESS_OFFSET], _dmx_slots_a);
+			  _dmx_buffer_c[0] = _packet_buffer[SACN_ADDRESS_OFFSET];
+			  LXDMXMerge::copySlots(&_dmx_buffer_c[1], &_packet_buffer[SACN_ADDRESS_OFFSET+1], dsize-1,
+			                        merge_slots(dsize-1), &_changes);
 		   }
            int slots = _dmx_slots_a-1;					//remove extra 1 for start code
            if ( _dmx_slots_b > _dmx_slots_a ) {
@@ -388,26 +859,24 @@ uint16_t LXWiFiSACN::parse_dmp_layer( uint16_t size ) {
            
            return slots;	// <- CID matches sender_id_a
            
-        } else if ( _packet_buffer[SACN_PRIORITY_OFFSET] == _priority_a ) {
-           // if CID did not match sender_a and message has equal priority, this could be sender_b
-           if ( _dmx_sender_id_b[0] == 0  ) {	
-              for(int k=0; k<SACN_CID_LENGTH; k++) {		 // if _dmx_sender_id is not set
-                 _dmx_sender_id_b[k] = _packet_buffer[k+22];  // set it to id of this packet
-               }
-           }
-           if ( compareCID(&_dmx_sender_id_b[0], &_packet_buffer[22]) ) {
+        } else if ( source == SACN_SOURCE_B ) {
+              if ( _dmx_slots_b == 0 ) {
+                 // leaving single source mode, 'a' was not kept while _dmx_buffer_c held its levels
+                 memcpy(_dmx_buffer_a, _dmx_buffer_c, _dmx_slots_a);
+              }
               _dmx_slots_b = dsize;
               _last_packet_b = millis();
               _priority_b = _packet_buffer[SACN_PRIORITY_OFFSET];
-              int di;
-			  for (di=0; di<_dmx_slots_b; di++) {
-				 _dmx_buffer_b[di] = _packet_buffer[SACN_ADDRESS_OFFSET+di];
-				// always HTP (b does not exist unless priority is equal to a)
-				 if ( _dmx_buffer_a[di] > _dmx_buffer_b[di] ) {
-					_dmx_buffer_c[di] = _dmx_buffer_a[di];
-				 } else {
-					_dmx_buffer_c[di] = _dmx_buffer_b[di];
-				 }
+			  // HTP when priority is equal to a, per slot if either sends 0xDD
+			  _dmx_buffer_b[0] = _packet_buffer[SACN_ADDRESS_OFFSET];
+			  _dmx_buffer_c[0] = ( _dmx_buffer_a[0] > _dmx_buffer_b[0] ) ? _dmx_buffer_a[0] : _dmx_buffer_b[0];
+			  if ( address_priority_merge() ) {
+				  LXDMXMerge::mergePriorityHTP(&_dmx_buffer_b[1], &_packet_buffer[SACN_ADDRESS_OFFSET+1], dsize-1,
+				                               &_address_priority[DMX_UNIVERSE_SIZE], &_dmx_buffer_a[1], _address_priority,
+				                               &_dmx_buffer_c[1], merge_slots(dsize-1), &_changes);
+			  } else {
+				  LXDMXMerge::mergeHTP(&_dmx_buffer_b[1], &_packet_buffer[SACN_ADDRESS_OFFSET+1], dsize-1,
+				                       &_dmx_buffer_a[1], &_dmx_buffer_c[1], merge_slots(dsize-1), &_changes);
 			  }
 			  int slots = _dmx_slots_b - 1;					//remove extra 1 for start code
 			  if ( _dmx_slots_a > _dmx_slots_b ) {
@@ -416,14 +885,263 @@ uint16_t LXWiFiSACN::parse_dmp_layer( uint16_t size ) {
 			  
               return slots;
               
-           }//<=CID match sender b
-        }	// <=priority == sender a
+        }	// <=CID match sender b
       }		// <=format
     }		// <=setProperty
   }			// <=flags && length
   return 0;
 }
 
+/*
+  E1.31 6.2.6: the levels in a Stream_Terminated packet are ignored and the source is
+  released at once instead of after SACN_SOURCE_TIMEOUT
+  returns the number of slots if the output was merged again from the remaining source
+  when the last source terminates the output holds its levels until a new source is received
+*/
+uint16_t LXWiFiSACN::terminate_source( void ) {
+	LXDMXMerge::clearChanges(&_changes);
+	if ( _dmx_sender_id_a[0] && compareCID(&_dmx_sender_id_a[0], &_packet_buffer[22]) ) {
+		if ( _dmx_slots_b == 0 ) {
+			release_source_a();
+			return 0;
+		}
+		promote_source_b();
+	} else if ( _dmx_sender_id_b[0] && compareCID(&_dmx_sender_id_b[0], &_packet_buffer[22]) ) {
+		clearDMXSourceB();
+		merge_source_a();
+	} else {
+		return 0;
+	}
+	if ( _changes.first == DMX_NO_CHANGE ) {
+		return 0;
+	}
+	return _dmx_slots_a - 1;
+}
+
+/*
+  sender a is the first sender accepted, sender b the second
+  a new sender replaces both if its packet priority is above every slot of a and b.
+  Otherwise it becomes b if b is free and either its packet priority is equal to a
+  or per-address priority is in use, by a, b or this sender.  The slot priorities then
+  decide each slot, so a sender with a lower packet priority can still own slots with 0xDD.
+  Without 0xDD, b is released when its priority drops below a and replaces a when it rises above.
+  a 0xDD packet can start sender b but not a, the first sender is taken from its levels.
+*/
+uint8_t LXWiFiSACN::select_source( uint8_t address_priority ) {
+	if ( ! address_priority ) {
+		expire_sources();
+	}
+	if ( _dmx_sender_id_a[0] && compareCID(&_dmx_sender_id_a[0], &_packet_buffer[22]) ) {
+		return SACN_SOURCE_A;
+	}
+	
+	uint8_t priority = _packet_buffer[SACN_PRIORITY_OFFSET];
+	uint8_t per_address = address_priority || uses_address_priority(SACN_SOURCE_A) || uses_address_priority(SACN_SOURCE_B);
+	
+	if ( _dmx_sender_id_b[0] && compareCID(&_dmx_sender_id_b[0], &_packet_buffer[22]) ) {
+		if ( ! per_address ) {
+			if ( priority < _priority_a ) {
+				clearDMXSourceB();
+				return SACN_NO_SOURCE;
+			}
+			if (( priority > _priority_a ) && _dmx_slots_b ) {
+				promote_source_b();
+				return SACN_SOURCE_A;
+			}
+		}
+		return SACN_SOURCE_B;
+	}
+	
+	if ( _dmx_sender_id_a[0] == 0 ) {
+		if ( address_priority ) {
+			return SACN_NO_SOURCE;
+		}
+	} else if ( address_priority || ( priority <= highest_priority() ) ) {
+		if (( _dmx_sender_id_b[0] == 0 ) && ( per_address || ( priority == _priority_a ) )) {
+			memcpy(_dmx_sender_id_b, &_packet_buffer[22], SACN_CID_LENGTH);
+			start_sequence(&_sequence_b, _packet_buffer[SACN_SEQUENCE_OFFSET]);
+			_last_packet_b = millis();
+			return SACN_SOURCE_B;
+		}
+		return SACN_NO_SOURCE;
+	} else if ( _dmx_sender_id_b[0] ) {
+		clearDMXSourceB();
+	}
+	
+	memcpy(_dmx_sender_id_a, &_packet_buffer[22], SACN_CID_LENGTH);
+	start_sequence(&_sequence_a, _packet_buffer[SACN_SEQUENCE_OFFSET]);
+	clear_address_priority(SACN_SOURCE_A);
+	clear_sync_sequence(SACN_SOURCE_A);
+	return SACN_SOURCE_A;
+}
+
+/*
+  a sender not heard from for SACN_SOURCE_TIMEOUT is released, b takes the place of a
+  the output is merged again by the packet being received
+*/
+void LXWiFiSACN::expire_sources( void ) {
+	if ( _dmx_sender_id_b[0] && ( millis() - _last_packet_b > SACN_SOURCE_TIMEOUT ) ) {
+		clearDMXSourceB();
+	}
+	if ( _dmx_sender_id_a[0] && ( millis() - _last_packet_a > SACN_SOURCE_TIMEOUT ) ) {
+		if ( _dmx_slots_b ) {
+			promote_source_b();
+		} else {
+			release_source_a();
+		}
+	}
+}
+
+/*
+  a is released with no levels from b to take its place (b may only have sent 0xDD)
+  the output holds its levels until a new source is received
+*/
+void LXWiFiSACN::release_source_a( void ) {
+	memset(_dmx_sender_id_a, 0, SACN_CID_LENGTH);
+	_priority_a = 0;
+	memset(&_sequence_a, 0, sizeof(SACNSourceSequence));
+	clear_address_priority(SACN_SOURCE_A);
+	clear_sync_sequence(SACN_SOURCE_A);
+	if ( _dmx_sender_id_b[0] ) {
+		clearDMXSourceB();
+	}
+}
+
+/*
+  b takes the place of a, with b gone a is a single source
+*/
+void LXWiFiSACN::promote_source_b( void ) {
+	memcpy(_dmx_sender_id_a, _dmx_sender_id_b, SACN_CID_LENGTH);
+	memcpy(_dmx_buffer_a, _dmx_buffer_b, SLOTS_AND_START_CODE);
+	_dmx_slots_a = _dmx_slots_b;
+	_priority_a = _priority_b;
+	_last_packet_a = _last_packet_b;
+	_sequence_a = _sequence_b;
+	_sync_sequence_in[SACN_SOURCE_A] = _sync_sequence_in[SACN_SOURCE_B];
+	_last_sync_in[SACN_SOURCE_A] = _last_sync_in[SACN_SOURCE_B];
+	if ( _address_priority ) {
+		memcpy(_address_priority, &_address_priority[DMX_UNIVERSE_SIZE], DMX_UNIVERSE_SIZE);
+		_priority_fill[SACN_SOURCE_A] = _priority_fill[SACN_SOURCE_B];
+		_last_address_priority[SACN_SOURCE_A] = _last_address_priority[SACN_SOURCE_B];
+	}
+	clearDMXSourceB();
+	merge_source_a();
+}
+
+/*
+  output from the levels of a alone, the single source levels are kept in _dmx_buffer_c
+*/
+void LXWiFiSACN::merge_source_a( void ) {
+	_dmx_buffer_c[0] = _dmx_buffer_a[0];
+	if ( address_priority_merge() ) {
+		LXDMXMerge::mergePriorityHTP(&_dmx_buffer_a[1], &_dmx_buffer_a[1], _dmx_slots_a-1,
+		                             _address_priority, &_dmx_buffer_b[1], &_address_priority[DMX_UNIVERSE_SIZE],
+		                             &_dmx_buffer_c[1], merge_slots(_dmx_slots_a-1), &_changes);
+	} else {
+		LXDMXMerge::copySlots(&_dmx_buffer_c[1], &_dmx_buffer_a[1], _dmx_slots_a-1,
+		                      merge_slots(_dmx_slots_a-1), &_changes);
+	}
+}
+
+/*
+  0xDD packets share the sequence of the sender's level packets and are checked with them
+  slots beyond the end of the packet are not sourced
+  the new priorities are used when the next level packet is merged
+  a new sender's 0xDD packet makes it sender b if b is free, whatever its packet priority
+*/
+void LXWiFiSACN::read_address_priority( uint16_t slots ) {
+	uint8_t source = select_source(1);
+	if ( source == SACN_NO_SOURCE ) {
+		return;
+	}
+	if ( _address_priority == NULL ) {
+		_address_priority = (uint8_t*) malloc(2 * DMX_UNIVERSE_SIZE);
+		if ( _address_priority == NULL ) {		// merge continues by packet priority
+			return;
+		}
+		memset(_address_priority, 0, 2 * DMX_UNIVERSE_SIZE);
+		_priority_fill[SACN_SOURCE_A] = 0;
+		_priority_fill[SACN_SOURCE_B] = 0;
+	}
+	if ( slots > DMX_UNIVERSE_SIZE ) {
+		slots = DMX_UNIVERSE_SIZE;
+	}
+	uint8_t* p = &_address_priority[source * DMX_UNIVERSE_SIZE];
+	memcpy(p, &_packet_buffer[SACN_ADDRESS_OFFSET+1], slots);
+	memset(&p[slots], 0, DMX_UNIVERSE_SIZE - slots);
+	_priority_fill[source] = SACN_ADDRESS_PRIORITY_RECEIVED;
+	_last_address_priority[source] = millis();
+}
+
+uint8_t LXWiFiSACN::address_priority_merge( void ) {
+	if ( _address_priority == NULL ) {
+		return 0;
+	}
+	uint8_t a = update_slot_priority(SACN_SOURCE_A, _priority_a);
+	uint8_t b = update_slot_priority(SACN_SOURCE_B, _priority_b);
+	return a | b;
+}
+
+/*
+  a sender that stops sending 0xDD for SACN_SOURCE_TIMEOUT reverts to its packet priority
+  _priority_b is 0 when b does not exist, so its slots are not sourced
+*/
+uint8_t LXWiFiSACN::update_slot_priority( uint8_t source, uint8_t packet_priority ) {
+	if ( uses_address_priority(source) ) {
+		return 1;
+	}
+	if ( _priority_fill[source] == packet_priority ) {
+		return 0;
+	}
+	memset(&_address_priority[source * DMX_UNIVERSE_SIZE], packet_priority, DMX_UNIVERSE_SIZE);
+	_priority_fill[source] = packet_priority;
+	return 0;
+}
+
+uint8_t LXWiFiSACN::uses_address_priority( uint8_t source ) {
+	if (( _address_priority == NULL ) || ( _priority_fill[source] != SACN_ADDRESS_PRIORITY_RECEIVED )) {
+		return 0;
+	}
+	return ( millis() - _last_address_priority[source] <= SACN_SOURCE_TIMEOUT );
+}
+
+/*
+  a new sender above this priority wins every slot and replaces a and b
+*/
+uint8_t LXWiFiSACN::highest_priority( void ) {
+	uint8_t highest = ( _priority_a > _priority_b ) ? _priority_a : _priority_b;
+	for (uint8_t source=SACN_SOURCE_A; source<=SACN_SOURCE_B; source++) {
+		if ( uses_address_priority(source) ) {
+			uint8_t* p = &_address_priority[source * DMX_UNIVERSE_SIZE];
+			for (uint16_t i=0; i<DMX_UNIVERSE_SIZE; i++) {
+				if ( p[i] > highest ) {
+					highest = p[i];
+				}
+			}
+		}
+	}
+	return highest;
+}
+
+void LXWiFiSACN::clear_address_priority( uint8_t source ) {
+	if ( _address_priority ) {
+		memset(&_address_priority[source * DMX_UNIVERSE_SIZE], 0, DMX_UNIVERSE_SIZE);
+		_priority_fill[source] = 0;
+	}
+}
+
+/*
+  number of slots written by a merge
+  if the number of slots is shrinking, slots beyond the new count are zeroed
+  so that they are reported as changed
+*/
+uint16_t LXWiFiSACN::merge_slots( uint16_t t_slots ) {
+	if (( _dmx_slots > t_slots ) && ( _dmx_slots <= DMX_UNIVERSE_SIZE )) {
+		return _dmx_slots;
+	}
+	return t_slots;
+}
+
 //  utility for checking 2 byte:  flags (high nibble == 0x7) && 12 bit length
 
 uint8_t LXWiFiSACN::checkFlagsAndLength( uint8_t* flb, uint16_t size ) {
@@ -12,13 +12,54 @@
 #include <Arduino.h>
 #include <inttypes.h>
 #include "LXDMXWiFi.h"
+#include "LXDMXWiFiMerge.h"
 
 #define SACN_PORT 0x15C0
 #define SACN_BUFFER_MAX 638
 #define SACN_PRIORITY_OFFSET 108
+#define SACN_SYNC_ADDRESS_OFFSET 109
+#define SACN_SEQUENCE_OFFSET 111
+#define SACN_OPTIONS_OFFSET 112
 #define SACN_ADDRESS_OFFSET 125
 #define SACN_CID_LENGTH 16
+#define SACN_SOURCE_NAME_OFFSET 44
+#define SACN_SOURCE_NAME_LENGTH 64
+#define SACN_DEFAULT_PRIORITY 100
 #define SLOTS_AND_START_CODE 513
+#define SACN_KEEPALIVE_INTERVAL 900
+#define SACN_CHANGE_REPEATS 3
+#define SACN_SEQUENCE_WINDOW 20
+#define SACN_DISCOVERY_HEADER_SIZE 120
+#define SACN_DISCOVERY_PAGE_SIZE 512
+#define SACN_DISCOVERY_INTERVAL 10000
+#define SACN_SOURCE_TIMEOUT 3000
+#define SACN_SYNC_SIZE 49
+#define SACN_SYNC_SEQUENCE_OFFSET 44
+#define SACN_SYNC_TIMEOUT 2500
+#define SACN_PRIORITY_START_CODE 0xDD
+#define SACN_ADDRESS_PRIORITY_RECEIVED 0x100
+
+// framing layer options
+#define SACN_OPTION_PREVIEW 0x80
+#define SACN_OPTION_TERMINATED 0x40
+#define SACN_OPTION_FORCE_SYNC 0x20
+
+// source index for sequence counts and per-address priority
+#define SACN_SOURCE_A 0
+#define SACN_SOURCE_B 1
+#define SACN_NO_SOURCE 0xff
+
+/*!
+* @brief sequence state of a sender being received
+* @discussion gaps and reorders are reset when a different CID takes the place of the sender
+*/
+typedef struct {
+	uint8_t  sequence;
+	uint32_t gaps;
+	uint32_t reorders;
+} SACNSourceSequence;
+
+class LXWiFiSACNDiscovery;
 
 /*!
 * @class LXWiFiSACN
@@ -101,11 +142,74 @@ class LXWiFiSACN : public LXDMXWiFi {
 */
    void     setStartCode ( uint8_t value );
  /*!
- * @brief direct pointer to dmx buffer uint8_t[]
- * @return uint8_t* to dmx data buffer
+ * @brief direct pointer to outgoing dmx data, start code followed by slots
+ * @return uint8_t* to dmx data buffer or NULL if it could not be allocated
  */
    uint8_t* dmxData      ( void );
 
+ /*!
+ * @brief set CID identifying this sender in outgoing packets
+ * @discussion The default is a random UUID made when the transmit buffer is created.
+ *             A CID that stays the same across restarts (for example, built from the MAC address)
+ *             should be set where receivers need to recognize this source after a reboot.
+ *             Boards with an unseeded random() should call randomSeed() first.
+ * @param cid 16 byte UUID
+ */
+   void     setCID        ( uint8_t* cid );
+ /*!
+ * @brief set source name of outgoing packets
+ * @param name up to 63 characters (default "Arduino")
+ */
+   void     setSourceName ( const char* name );
+ /*!
+ * @brief set priority of outgoing packets
+ * @param priority 0 to 200 (default SACN_DEFAULT_PRIORITY)
+ */
+   void     setPriority   ( uint8_t priority );
+
+ /*!
+ * @brief first slot changed by the last sACN DMX packet read
+ * @return slot 1 to 512 or 0 if no slots changed
+ */
+   uint16_t changedSlotsFirst ( void );
+ /*!
+ * @brief last slot changed by the last sACN DMX packet read
+ * @return slot 1 to 512 or 0 if no slots changed
+ */
+   uint16_t changedSlotsLast  ( void );
+ /*!
+ * @brief test if a slot was changed by the last sACN DMX packet read
+ * @param slot 1 to 512
+ * @return 1 if slot changed
+ */
+   uint8_t  slotChanged       ( int slot );
+ /*!
+ * @brief enable per-slot change bitmap
+ * @param en 1 to maintain bitmap
+ */
+   void     setChangedSlotBitmap ( uint8_t en );
+ /*!
+ * @brief direct pointer to changed slot bitmap
+ * @return uint8_t[64], one bit per slot
+ */
+   uint8_t* changedSlotBitmap ( void );
+
+ /*!
+ * @brief number of packets missing from the sequence of a sender
+ * @discussion counts the packets skipped over when a sequence number jumps ahead
+ * @param source SACN_SOURCE_A (highest priority) or SACN_SOURCE_B (merged at equal priority)
+ */
+   uint32_t sequenceGapCount ( uint8_t source );
+ /*!
+ * @brief number of packets from a sender discarded because they arrived late or out of order
+ * @param source SACN_SOURCE_A (highest priority) or SACN_SOURCE_B (merged at equal priority)
+ */
+   uint32_t sequenceReorderCount ( uint8_t source );
+ /*!
+ * @brief reset sequence gap and reorder counts of both senders to zero
+ */
+   void     resetSequenceCounts ( void );
+
  /*!
  * @brief direct pointer to packet buffer uint8_t[]
  * @return uint8_t* to packet buffer
@@ -147,6 +251,70 @@ class LXWiFiSACN : public LXDMXWiFi {
  * @param interfaceAddr != 0 for multicast
  */  
    void sendDMX ( UDP* wUDP, IPAddress to_ip, IPAddress interfaceAddr );
+ /*!
+ * @brief send sACN E1.31 packet only if levels have changed or a keepalive is due
+ * @discussion Following E1.31, a change is sent followed by SACN_CHANGE_REPEATS
+ *             identical packets.  Unchanged data is then sent every SACN_KEEPALIVE_INTERVAL.
+ * @param wUDP pointer to UDP object to be used to send packet
+ * @param to_ip target address
+ * @param interfaceAddr != 0 for multicast
+ * @return 1 if a packet was sent
+ */
+   uint8_t sendDMXOnChange ( UDP* wUDP, IPAddress to_ip, IPAddress interfaceAddr );
+ /*!
+ * @brief minimum time between packets sent by sendDMXOnChange
+ * @param ms milliseconds
+ */
+   void setMinimumSendInterval ( uint16_t ms );
+
+ /*!
+ * @brief synchronization universe of outgoing packets
+ * @discussion Receivers hold packets with a synchronization universe until sendSync.
+ * @param u universe 1-63999, 0 (default) for packets that are output at once
+ */
+   void setSyncAddress ( uint16_t u );
+ /*!
+ * @brief send an E1.31 synchronization packet for the synchronization universe
+ * @discussion Send after the packets of all universes in a frame have been sent.
+ * @param wUDP pointer to UDP object to be used to send packet
+ * @param to_ip target address, the multicast address of the synchronization universe
+ * @param interfaceAddr != 0 for multicast
+ */
+   void sendSync ( UDP* wUDP, IPAddress to_ip, IPAddress interfaceAddr );
+
+ /*!
+ * @brief send E1.31 universe discovery listing universes being sent
+ * @discussion Sent to the universe discovery multicast address 239.255.250.214 using the
+ *             CID and source name of this instance.  Lists longer than SACN_DISCOVERY_PAGE_SIZE
+ *             are sent as several pages.  Discovery should be sent every SACN_DISCOVERY_INTERVAL.
+ * @param wUDP pointer to UDP object to be used to send packet
+ * @param interfaceAddr != 0 for multicast from a specific interface
+ * @param universes list of universes in ascending order
+ * @param count number of universes
+ */
+   void sendUniverseDiscovery ( UDP* wUDP, IPAddress interfaceAddr, uint16_t* universes, uint16_t count );
+ /*!
+ * @brief send universe discovery for universe() if SACN_DISCOVERY_INTERVAL has passed
+ * @param wUDP pointer to UDP object to be used to send packet
+ * @param interfaceAddr != 0 for multicast from a specific interface
+ * @return 1 if discovery was sent
+ */
+   uint8_t sendUniverseDiscoveryOnInterval ( UDP* wUDP, IPAddress interfaceAddr );
+
+ /*!
+ * @brief table of universes found in universe discovery packets
+ * @discussion Created on first call.  Once it exists, universe discovery packets read by
+ *             this instance are added to it.  To receive them, the UDP object must also
+ *             join multicast group 239.255.250.214.
+ * @return pointer to LXWiFiSACNDiscovery
+ */
+   LXWiFiSACNDiscovery* discovery ( void );
+ /*!
+ * @brief use a table shared with other instances
+ * @discussion The table is not deleted with this instance.
+ * @param d pointer to LXWiFiSACNDiscovery or NULL to stop reading discovery
+ */
+   void setDiscovery ( LXWiFiSACNDiscovery* d );
    
  /*!
  * @brief clear dmx buffers and sender CIDs
@@ -156,11 +324,10 @@ class LXWiFiSACN : public LXDMXWiFi {
    
   private:
 /*!
-* @brief buffer that holds contents of incoming or outgoing packet
+* @brief buffer that holds contents of incoming packet
 * @discussion readSACNPacket fills the buffer with the payload of the incoming packet.
 *             this is then copied into _dmx_buffer_a or _dmx_buffer_b depending on the sender
 *             at the same time it is merged HTP into _dmx_buffer_c
-*             DMX data to be sent is written directly to _packet_buffer
 */
   	uint8_t*   _packet_buffer;
 /*!
@@ -175,6 +342,8 @@ class LXWiFiSACN : public LXDMXWiFi {
 * @brief buffers that hold DMX data from source a, source b and HTP composite
 * @discussion data is read into _dmx_buffer_a or _dmx_buffer_b depending on the
 *             IP address of the sender, at the same time it is merged into _dmx_buffer_c.
+*             While there is only a single sender, its data is copied directly into
+*             _dmx_buffer_c and _dmx_buffer_a is not used.
 */
   	uint8_t   _dmx_buffer_a[DMX_UNIVERSE_SIZE+1];
   	uint8_t   _dmx_buffer_b[DMX_UNIVERSE_SIZE+1];
@@ -184,6 +353,8 @@ class LXWiFiSACN : public LXDMXWiFi {
   	int       _dmx_slots;
   	int       _dmx_slots_a;
   	int       _dmx_slots_b;
+/// slots of _dmx_buffer_c changed by the last sACN DMX packet (indexes are slot-1)
+  	LXDMXChanges _changes;
   	uint8_t   _priority_a;
   	uint8_t   _priority_b;
   	long      _last_packet_a;
@@ -192,9 +363,66 @@ class LXWiFiSACN : public LXDMXWiFi {
   	uint16_t  _universe;
 /// sequence number for sending sACN DMX packets
   	uint8_t   _sequence;
+/*!
+* @brief sACN DMX packet for sendDMX, allocated on first use
+* @discussion separate from _packet_buffer so that reading packets does not disturb
+*             outgoing data.  Root, framing and DMP layers are written once.
+*/
+  	uint8_t*  _tx_buffer;
+/// outgoing levels have been changed since the last sendDMX
+  	uint8_t   _tx_changed;
+/// start code and levels of the last packet sent, allocated when dmxData() is first called
+  	uint8_t*  _tx_last;
+/// identical packets remaining to be sent after a change
+  	uint8_t   _tx_repeats;
+/// number of slots in the last packet sent
+  	int       _tx_slots;
+/// time the last packet was sent
+  	unsigned long _last_send;
+/// minimum time between packets sent by sendDMXOnChange
+  	uint16_t  _min_send_interval;
+/// sequence number for sending synchronization packets
+  	uint8_t   _sync_sequence;
+/// time universe discovery was last sent by sendUniverseDiscoveryOnInterval
+  	unsigned long _last_discovery;
+/// table of universes found in universe discovery, NULL until discovery() is called
+  	LXWiFiSACNDiscovery* _discovery;
+/// flag indicating _discovery was created by this instance
+  	uint8_t   _owns_discovery;
 /// cid of first sender of an E 1.31 DMX packet (subsequent senders ignored)
   	uint8_t _dmx_sender_id_a[SACN_CID_LENGTH];
   	uint8_t _dmx_sender_id_b[SACN_CID_LENGTH];
+/// sequence of sender a and sender b
+  	SACNSourceSequence _sequence_a;
+  	SACNSourceSequence _sequence_b;
+/*!
+* @brief per slot priority of sender a followed by sender b, allocated on the first 0xDD packet
+* @discussion a sender that is not sending 0xDD packets has its packet priority in every slot.
+*             Index is slot-1, like the merge buffers without their start code.
+*/
+  	uint8_t*  _address_priority;
+/// packet priority filling a sender's slots or SACN_ADDRESS_PRIORITY_RECEIVED
+  	uint16_t  _priority_fill[2];
+/// time the last 0xDD packet was received from each sender
+  	unsigned long _last_address_priority[2];
+/*!
+* @brief levels last published by a synchronization packet, allocated on first use
+* @discussion while holding, synchronized packets are merged into _dmx_buffer_c as usual
+*             and getSlot reads this buffer.  _dmx_buffer_c is copied here by each sync.
+*/
+  	uint8_t*  _sync_buffer;
+/// output is being held for synchronization packets
+  	uint8_t   _sync_holding;
+/// number of slots merged since the last synchronization, 0 if none
+  	uint16_t  _sync_slots;
+/// synchronization universe of the last packet used
+  	uint16_t  _sync_address;
+/// time the last synchronization packet for _sync_address was received
+  	unsigned long _last_sync;
+/// sequence of synchronization packets from sender a and sender b, independent of their data packets
+  	SACNSourceSequence _sync_sequence_in[2];
+/// time the last synchronization packet was received from each sender
+  	unsigned long _last_sync_in[2];
 
 /*!
 * @brief checks the buffer for the sACN header and root layer size
@@ -205,7 +433,109 @@ class LXWiFiSACN : public LXDMXWiFi {
 */  
   	uint16_t  parse_framing_layer ( uint16_t size );	
   	uint16_t  parse_dmp_layer     ( uint16_t size );
+/*!
+* @brief publish held levels for an E1.31 synchronization packet
+* @return number of slots if levels were published
+*/
+  	uint16_t  parse_sync_packet   ( uint16_t size );
+/*!
+* @brief check if the packet is synchronized and sync packets are being received
+* @discussion when not already holding, the current output is saved to _sync_buffer so that it
+*             can be kept if the packet is accepted.  Holding only starts once it is accepted.
+* @return 1 if the packet should be held, 0 to output at once (including if _sync_buffer cannot be allocated)
+*/
+  	uint8_t   hold_for_sync       ( uint16_t sync_address );
+/*!
+* @brief forget the synchronization sequence of sender a or b
+*/
+  	void      clear_sync_sequence ( uint8_t source );
+/*!
+* @brief copy _dmx_buffer_c to the published levels, recording the changes
+*/
+  	void      publish_sync        ( void );
+/*!
+* @brief number of slots to write when merging a packet with t_slots (excluding start code)
+*/
+  	uint16_t  merge_slots         ( uint16_t t_slots );
+/*!
+* @brief check the sequence of a packet against the last from the same sender (E1.31 6.7.2)
+* @discussion updates the sequence and the gap/reorder counts
+* @param sequence number of the packet
+* @return 1 if packet should be used, 0 if it is late or out of order
+*/
+  	uint8_t   check_sequence      ( SACNSourceSequence* source, uint8_t sequence );
+/*!
+* @brief start tracking the sequence of a new sender from the current packet
+*/
+  	void      start_sequence      ( SACNSourceSequence* source, uint8_t sequence );
+/*!
+* @brief find or accept the sender of a packet as sender a or b
+* @discussion a second sender is accepted when its priority is equal to a or per-address priority is in use
+* @param address_priority 1 for a 0xDD packet, which can only start sender b
+* @return SACN_SOURCE_A, SACN_SOURCE_B or SACN_NO_SOURCE if the packet is not merged
+*/
+  	uint8_t   select_source       ( uint8_t address_priority );
+/*!
+* @brief release senders not heard from for SACN_SOURCE_TIMEOUT
+*/
+  	void      expire_sources      ( void );
+/*!
+* @brief release sender a when there are no levels from b to take its place
+*/
+  	void      release_source_a    ( void );
+/*!
+* @brief release the sender of a Stream_Terminated packet and merge the remaining sender
+* @return number of slots if the output was merged again, otherwise 0
+*/
+  	uint16_t  terminate_source    ( void );
+/*!
+* @brief move sender b to a when a is released
+*/
+  	void      promote_source_b    ( void );
+/*!
+* @brief write the output from the levels of sender a alone
+*/
+  	void      merge_source_a      ( void );
+/*!
+* @brief store the per-address priority (0xDD start code) packet of sender a or b
+* @discussion a new sender becomes sender b if b is free, packets from other senders are ignored
+*/
+  	void      read_address_priority  ( uint16_t slots );
+/*!
+* @brief refresh the per slot priority of sender a and b before a merge
+* @return 1 if either sender is sending per-address priority
+*/
+  	uint8_t   address_priority_merge ( void );
+/*!
+* @brief fill a sender's slots with its packet priority unless it is sending per-address priority
+* @return 1 if the sender is sending per-address priority
+*/
+  	uint8_t   update_slot_priority   ( uint8_t source, uint8_t packet_priority );
+/*!
+* @brief sender has sent per-address priority within SACN_SOURCE_TIMEOUT
+*/
+  	uint8_t   uses_address_priority  ( uint8_t source );
+/*!
+* @brief highest packet or slot priority of sender a and b
+*/
+  	uint8_t   highest_priority       ( void );
+/*!
+* @brief forget the per-address priority of a sender
+*/
+  	void      clear_address_priority ( uint8_t source );
   	uint8_t   checkFlagsAndLength ( uint8_t* flb, uint16_t size );
+/*!
+* @brief transmit buffer, allocating and writing the packet template if needed
+*/
+  	uint8_t*  tx_buffer           ( void );
+/*!
+* @brief outgoing levels, start code or slot count differ from the last packet sent
+*/
+  	uint8_t   tx_changed          ( void );
+/*!
+* @brief begin a packet, using multicast from interfaceAddr if it is specified
+*/
+  	void      begin_packet        ( UDP* wUDP, IPAddress to_ip, IPAddress interfaceAddr );
   	
 /*!
 * @brief initialize data structures
@@ -0,0 +1,209 @@
+/**************************************************************************/
+/*!
+    @file     LXWiFiSACNDiscovery.cpp
+    @author   Claude Heintz
+    @license  BSD (see LXDMXWiFi.h)
+    @copyright 2026 by Claude Heintz All Rights Reserved
+
+    Table of universes found by E1.31 universe discovery.
+
+    sACN E 1.31 is a public standard published by the PLASA technical standards program
+    http://tsp.plasa.org/tsp/documents/published_docs.php
+
+    @section  HISTORY
+
+    v1.0 - First release
+*/
+/**************************************************************************/
+
+#include "LXWiFiSACNDiscovery.h"
+
+/*
+  returns the pdu length, or zero if flags are not 0x7
+*/
+static uint16_t discoveryPDULength( uint8_t* flb ) {
+	if ( ( flb[0] & 0xF0 ) == 0x70 ) {
+		return ((flb[0] & 0x0f) << 8) | flb[1];
+	}
+	return 0;
+}
+
+LXWiFiSACNDiscovery::LXWiFiSACNDiscovery ( void )
+{
+	_source_count = 0;
+	_universe_count = 0;
+}
+
+/*
+  root vector VECTOR_ROOT_E131_EXTENDED, framing vector VECTOR_E131_EXTENDED_DISCOVERY,
+  discovery vector VECTOR_UNIVERSE_DISCOVERY_UNIVERSE_LIST
+  universes are read directly from the packet, two bytes each starting at 120
+  a full page is larger than SACN_BUFFER_MAX, so a page cut short by the receive buffer
+  is read up to its end
+*/
+uint8_t LXWiFiSACNDiscovery::readDiscoveryPacket ( uint8_t* packet, uint16_t packetSize ) {
+	if (( packetSize < SACN_DISCOVERY_HEADER_SIZE ) || ( packet[1] != 0x10 )) {
+		return 0;
+	}
+	if ( strcmp((const char*)&packet[4], "ASC-E1.17") != 0 ) {
+		return 0;
+	}
+	uint16_t pdu_length = discoveryPDULength(&packet[112]);
+	if (( discoveryPDULength(&packet[16]) != pdu_length + 96 ) || ( packet[21] != 0x08 )) {
+		return 0;
+	}
+	if (( discoveryPDULength(&packet[38]) != pdu_length + 74 ) || ( packet[43] != 0x02 )) {
+		return 0;
+	}
+	if (( pdu_length < 8 ) || ( pdu_length > 8 + 2 * SACN_DISCOVERY_PAGE_SIZE ) || ( packet[117] != 0x01 )) {
+		return 0;
+	}
+	if ( pdu_length > packetSize - 112 ) {
+		pdu_length = packetSize - 112;
+	}
+	uint16_t count = (pdu_length - 8) / 2;
+
+	update();
+	unsigned long now = millis();
+	uint8_t source = source_for_cid(&packet[22]);
+	SACNDiscoverySource* s = &_sources[source];
+	memcpy(s->name, &packet[44], SACN_SOURCE_NAME_LENGTH);
+	s->name[SACN_SOURCE_NAME_LENGTH-1] = 0;
+	s->last_packet = now;
+	if ( packet[118] == 0 ) {
+		s->list_start = now;
+	}
+
+	uint8_t* data = &packet[SACN_DISCOVERY_HEADER_SIZE];
+	for (uint16_t n=0; n<count; n++) {
+		uint16_t u = (data[2*n] << 8) | data[2*n+1];
+		int k;
+		for (k=0; k<_universe_count; k++) {
+			if (( _universes[k].universe == u ) && ( _universes[k].source == source )) {
+				break;
+			}
+		}
+		if ( k == _universe_count ) {
+			if ( _universe_count == SACN_DISCOVERY_MAX_UNIVERSES ) {
+				continue;						// table is full
+			}
+			_universes[k].universe = u;
+			_universes[k].source = source;
+			_universe_count++;
+		}
+		_universes[k].last_listed = now;
+	}
+
+	if ( packet[118] == packet[119] ) {			// last page, list is complete
+		remove_universes(source, s->list_start);
+	}
+	return 1;
+}
+
+void LXWiFiSACNDiscovery::update ( void ) {
+	unsigned long now = millis();
+	int k = 0;
+	while ( k < _source_count ) {
+		if ( now - _sources[k].last_packet > SACN_DISCOVERY_TIMEOUT ) {
+			remove_source(k);
+		} else {
+			k++;
+		}
+	}
+}
+
+uint8_t LXWiFiSACNDiscovery::numberOfSources ( void ) {
+	return _source_count;
+}
+
+uint8_t* LXWiFiSACNDiscovery::sourceCID ( uint8_t index ) {
+	if ( index < _source_count ) {
+		return _sources[index].cid;
+	}
+	return NULL;
+}
+
+char* LXWiFiSACNDiscovery::sourceName ( uint8_t index ) {
+	if ( index < _source_count ) {
+		return _sources[index].name;
+	}
+	return NULL;
+}
+
+uint8_t LXWiFiSACNDiscovery::numberOfUniverses ( void ) {
+	return _universe_count;
+}
+
+uint16_t LXWiFiSACNDiscovery::universeAtIndex ( uint8_t index ) {
+	if ( index < _universe_count ) {
+		return _universes[index].universe;
+	}
+	return 0;
+}
+
+uint8_t LXWiFiSACNDiscovery::universeSourceAtIndex ( uint8_t index ) {
+	if ( index < _universe_count ) {
+		return _universes[index].source;
+	}
+	return SACN_DISCOVERY_NO_SOURCE;
+}
+
+uint8_t LXWiFiSACNDiscovery::hasUniverse ( uint16_t u ) {
+	uint8_t n = 0;
+	for (int k=0; k<_universe_count; k++) {
+		if ( _universes[k].universe == u ) {
+			n++;
+		}
+	}
+	return n;
+}
+
+uint8_t LXWiFiSACNDiscovery::source_for_cid ( uint8_t* cid ) {
+	for (int k=0; k<_source_count; k++) {
+		if ( memcmp(_sources[k].cid, cid, SACN_CID_LENGTH) == 0 ) {
+			return k;
+		}
+	}
+	if ( _source_count == SACN_DISCOVERY_MAX_SOURCES ) {		// table is full, replace the oldest
+		unsigned long now = millis();
+		uint8_t oldest = 0;
+		for (int k=1; k<_source_count; k++) {
+			if ( now - _sources[k].last_packet > now - _sources[oldest].last_packet ) {
+				oldest = k;
+			}
+		}
+		remove_source(oldest);
+	}
+	uint8_t index = _source_count++;
+	memcpy(_sources[index].cid, cid, SACN_CID_LENGTH);
+	_sources[index].list_start = millis();
+	return index;
+}
+
+/*
+  the last source takes the place of the removed one and its universes are renumbered
+*/
+void LXWiFiSACNDiscovery::remove_source ( uint8_t index ) {
+	remove_universes(index, millis() + 1);
+	_source_count--;
+	if ( index != _source_count ) {
+		_sources[index] = _sources[_source_count];
+		for (int k=0; k<_universe_count; k++) {
+			if ( _universes[k].source == _source_count ) {
+				_universes[k].source = index;
+			}
+		}
+	}
+}
+
+void LXWiFiSACNDiscovery::remove_universes ( uint8_t source, unsigned long before ) {
+	int k = 0;
+	while ( k < _universe_count ) {
+		if (( _universes[k].source == source ) && ( (long)(before - _universes[k].last_listed) > 0 )) {
+			_universe_count--;
+			_universes[k] = _universes[_universe_count];
+		} else {
+			k++;
+		}
+	}
+}
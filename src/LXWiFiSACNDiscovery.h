@@ -0,0 +1,136 @@
+/* LXWiFiSACNDiscovery.h
+   Copyright 2026 by Claude Heintz Design
+   see LXDMXWiFi.h for LICENSE
+
+   sACN E 1.31 is a public standard published by the PLASA technical standards program
+   http://tsp.plasa.org/tsp/documents/published_docs.php
+*/
+
+#ifndef LXWIFISACNDISCOVERY_H
+#define LXWIFISACNDISCOVERY_H
+
+#include <Arduino.h>
+#include "LXDMXWiFi.h"
+#include "LXWiFiSACN.h"
+
+#define SACN_DISCOVERY_MAX_SOURCES 8
+#define SACN_DISCOVERY_MAX_UNIVERSES 64
+#define SACN_DISCOVERY_NO_SOURCE 0xff
+#define SACN_DISCOVERY_TIMEOUT 25000
+
+/*!
+* @brief a sender found in universe discovery packets
+*/
+typedef struct {
+	uint8_t       cid[SACN_CID_LENGTH];
+	char          name[SACN_SOURCE_NAME_LENGTH];
+	unsigned long last_packet;
+/// time page 0 of the current list was received
+	unsigned long list_start;
+} SACNDiscoverySource;
+
+/*!
+* @brief a universe listed by a source
+*/
+typedef struct {
+	uint16_t      universe;
+	uint8_t       source;
+	unsigned long last_listed;
+} SACNDiscoveryUniverse;
+
+/*!
+*  @class LXWiFiSACNDiscovery
+*  @abstract
+*     LXWiFiSACNDiscovery keeps a table of the universes being sent and their sources
+*     from E1.31 universe discovery packets.
+*
+*     A source lists its universes in pages every SACN_DISCOVERY_INTERVAL.  When the last
+*     page arrives, universes that the source no longer lists are removed.  A source that
+*     has not sent discovery for SACN_DISCOVERY_TIMEOUT is removed with its universes.
+*
+*     Use hasUniverse() to decide which multicast groups to join.
+*     LXWiFiSACN passes discovery packets to its table (see LXWiFiSACN::discovery).
+*/
+class LXWiFiSACNDiscovery {
+
+  public:
+/*!
+* @brief constructor
+*/
+	LXWiFiSACNDiscovery  ( void );
+
+/*!
+* @brief add the universes of a universe discovery packet to the table
+* @param packet contents of sACN packet
+* @param packetSize size of packet
+* @return 1 if the packet was a valid universe discovery packet
+*/
+	uint8_t readDiscoveryPacket ( uint8_t* packet, uint16_t packetSize );
+
+/*!
+* @brief remove sources that have not sent discovery for SACN_DISCOVERY_TIMEOUT
+* @discussion called when reading packets, call from loop if none may arrive
+*/
+	void update ( void );
+
+/*!
+* @brief number of sources found
+*/
+	uint8_t numberOfSources ( void );
+/*!
+* @brief CID of a source
+* @param index 0 to numberOfSources()-1
+* @return pointer to 16 byte CID or NULL
+*/
+	uint8_t* sourceCID ( uint8_t index );
+/*!
+* @brief name of a source
+* @param index 0 to numberOfSources()-1
+* @return source name or NULL
+*/
+	char* sourceName ( uint8_t index );
+
+/*!
+* @brief number of entries in universe table
+* @discussion a universe sent by two sources has two entries
+*/
+	uint8_t numberOfUniverses ( void );
+/*!
+* @brief universe of an entry
+* @param index 0 to numberOfUniverses()-1
+* @return universe or 0 if index is out of range
+*/
+	uint16_t universeAtIndex ( uint8_t index );
+/*!
+* @brief source of an entry
+* @param index 0 to numberOfUniverses()-1
+* @return source index or SACN_DISCOVERY_NO_SOURCE
+*/
+	uint8_t universeSourceAtIndex ( uint8_t index );
+/*!
+* @brief number of sources listing a universe
+* @param u universe 1-63999
+*/
+	uint8_t hasUniverse ( uint16_t u );
+
+  private:
+	SACNDiscoverySource   _sources[SACN_DISCOVERY_MAX_SOURCES];
+	uint8_t               _source_count;
+	SACNDiscoveryUniverse _universes[SACN_DISCOVERY_MAX_UNIVERSES];
+	uint8_t               _universe_count;
+
+/*!
+* @brief find or add the source with a CID, replacing the oldest if the table is full
+*/
+	uint8_t source_for_cid     ( uint8_t* cid );
+/*!
+* @brief remove a source and its universes
+*/
+	void    remove_source      ( uint8_t index );
+/*!
+* @brief remove universes of a source last listed before a time
+*/
+	void    remove_universes   ( uint8_t source, unsigned long before );
+};
+
+#endif // ifndef LXWIFISACNDISCOVERY_H